@@ -0,0 +1,37 @@
+#ifndef ANALOG_INPUT_H_
+#define ANALOG_INPUT_H_
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//
+// Adds an analog channel, from 1 to 8, to be sampled in the background.
+// If calibrate is set, the current reading is taken as zero, as with analogCalibrate,
+// so the sensor must be still. Call from initialize(). Returns false if the channel is invalid.
+//
+bool analogInputAdd(unsigned char channel, bool calibrate);
+
+//
+// Starts the task that samples the added channels, unless it is already running or none were added.
+//
+void analogInputRun();
+
+//
+// Returns the latest filtered reading of a channel, as 16 times the 12-bit value
+// (the same scale as analogReadCalibratedHR), minus the calibrated zero if any.
+// Costs no more than reading a variable.
+//
+int analogInputGet(unsigned char channel);
+
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+// End include guard
+#endif
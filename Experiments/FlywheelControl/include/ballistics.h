@@ -0,0 +1,65 @@
+#ifndef BALLISTICS_H_
+#define BALLISTICS_H_
+
+#include <API.h>
+#include <stdbool.h>
+#include "flywheel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define BALLISTICS_MAX_POINTS 16                // Most calibration points the distance to rpm table can hold.
+
+//
+// Starts following the ultrasonic distance to the goal: the filtered distance is mapped to a target
+// rpm through the calibration table, which is set on the flywheel whenever it moves far enough.
+// The table is loaded from flash if it was saved, otherwise a default table is used.
+// Call from initialize(), before any other ballistics function.
+// Returns false if the sensor hub is full, in which case the table can still be calibrated.
+//
+bool ballisticsRun(Flywheel *flywheel, unsigned char portEcho, unsigned char portPing);
+
+//
+// Stops (false) or resumes (true) setting the flywheel's target, e.g. while the driver sets it by hand.
+// May be called before ballisticsRun(), to start it stopped.
+//
+void ballisticsSetActive(bool isActive);
+
+//
+// Returns the filtered distance to the goal in centimeters, or zero if it hasn't been seen.
+//
+float ballisticsDistance();
+
+//
+// Returns the target rpm for a distance in centimeters, interpolated from the calibration table.
+//
+float ballisticsRpm(float distance);
+
+//
+// Adds a calibration point, replacing any within a centimeter of it.
+// Returns false if the table is full.
+//
+bool ballisticsSetPoint(float distance, float rpm);
+
+//
+// Removes every calibration point, so that the table can be recalibrated from scratch.
+// The flywheel keeps its last target until a point is added.
+//
+void ballisticsClear();
+
+//
+// Writes the calibration table to flash.
+// Returns false while the robot is enabled, or if the file couldn't be written.
+//
+bool ballisticsSave();
+
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+// End include guard
+#endif
@@ -0,0 +1,29 @@
+#ifndef BATTERY_H_
+#define BATTERY_H_
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//
+// Returns the filtered main battery voltage, in volts.
+// The battery is only sampled at a low rate; other calls return the cached value.
+//
+float batteryVoltage();
+
+//
+// Returns the factor to scale motor outputs by so that they match what
+// they would do on a battery at the nominal voltage.
+//
+float batteryCompensation();
+
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+// End include guard
+#endif
@@ -0,0 +1,48 @@
+#ifndef CONTROL_H_
+#define CONTROL_H_
+
+#include <stdbool.h>
+#include "motors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//
+// Steps shared by the flywheel, the dual flywheel and the mechanisms, from an action proportional
+// to speed through to the motors. Errors are measured less target, so feedback gains are usually negative.
+//
+
+//
+// A PI step with conditional integration: the error integral is only added to the integral while
+// the action is within the limits, or while it would bring the action back within them.
+// The base, such as a feedforward or derivative term, is added to the action.
+// Returns the action, limited.
+//
+float controlIntegrate(float *integral, float base, float error, float errorIntegral, float kp, float ki, float minimum, float maximum);
+
+//
+// Narrows the limits to the action at which the group's output, once linearized, battery compensated
+// and capped by the thermal model, stops rising, so that anti-windup sees the output saturate where it really does.
+//
+void controlLimits(const MotorGroup *group, MotorType type, bool batteryCompensate, float minimum, float maximum, float *limitMinimum, float *limitMaximum);
+
+//
+// Linearizes the action into a motor value, compensates it for the battery if asked, and queues it for the group.
+//
+void controlOutput(const MotorGroup *group, MotorType type, bool batteryCompensate, float action);
+
+//
+// Tells the thermal model how fast the group spins, as the action that would spin it that fast unloaded.
+//
+void controlSetSpeed(const MotorGroup *group, MotorType type, float speedAction);
+
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+// End include guard
+#endif
@@ -0,0 +1,71 @@
+#ifndef DRIVE_H_
+#define DRIVE_H_
+
+#include <API.h>
+#include <stdbool.h>
+#include "mechanism.h"
+#include "motors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct DriveSetup
+{
+	unsigned char leftChannels[3];      // Motor channels driving the left side, zero-terminated.
+	bool leftReversed[3];
+	unsigned char rightChannels[3];     // Motor channels driving the right side, zero-terminated.
+	bool rightReversed[3];
+	unsigned char leftEncoderPortTop;
+	unsigned char leftEncoderPortBottom;
+	bool leftEncoderReverse;
+	unsigned char rightEncoderPortTop;
+	unsigned char rightEncoderPortBottom;
+	bool rightEncoderReverse;
+	int encoderTicksPerRevolution;
+	float wheelDiameter;                // Wheel diameter, in inches.
+	float freeSpeed;                    // Unloaded wheel speed, in inches per second, at full output.
+	float maximumSpeed;                 // Wheel speed, in inches per second, at full joystick; keep it under the free speed so the loops have headroom.
+	int deadband;                       // Joystick values this close to zero are taken as zero.
+	float kp;                           // Action per inch per second of error; negative, as with the flywheel.
+	float ki;
+	float smoothing;                    // Low-pass filter time constant, in seconds, of the wheel speeds.
+	float slewRate;                     // Fastest the output may change, per second, from -127 to 127.
+	float thermalWeight;                // Share of a port bank's thermal cut the drive takes; above one, it gives way before the other mechanisms.
+	MotorType motorType;
+	bool batteryCompensate;
+}
+DriveSetup;
+
+//
+// Sets up each side of the drive as a velocity mechanism closed around its encoder.
+// Call from initialize(), then start the mechanisms with mechanismsRun.
+//
+void driveInit(DriveSetup setup);
+
+//
+// Sets the wheel speeds from tank joystick values, from -127 to 127.
+//
+void driveTank(int left, int right);
+
+//
+// Sets the wheel speeds directly, in inches per second.
+//
+void driveSetSpeeds(float left, float right);
+
+//
+// Returns the mechanism driving each side, for the pose to be read from its position,
+// or NULL if that side could not be added.
+//
+Mechanism *driveLeft();
+Mechanism *driveRight();
+
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+// End include guard
+#endif
@@ -0,0 +1,79 @@
+#ifndef DUAL_FLYWHEEL_H_
+#define DUAL_FLYWHEEL_H_
+
+#include <API.h>
+#include <stdbool.h>
+#include "flywheel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//
+// Two flywheels that launch the ball between them, controlled together.
+// The mean speed and the difference in speed are controlled separately, so that a
+// shot slowing one wheel more than the other doesn't leave the pair mismatched.
+// Each wheel only runs its estimator; one task updates both wheels.
+// This is a library for two wheel launchers: this robot launches with a single wheel, so
+// initialize() doesn't create one, and it has only been checked to build.
+//
+typedef struct DualFlywheel
+{
+	Flywheel *wheels[2];
+
+	float target;                       // Mean target speed of the wheels, in rpm.
+	float spin;                         // Target speed of the first wheel less the second's, in rpm.
+	float commonError;                  // Mean of the wheels' errors, in rpm.
+	float differentialError;            // First wheel's error less the second's, in rpm.
+	float commonIntegral;               // Integral of the common error, in rpm seconds.
+	float differentialIntegral;         // Integral of the differential error, in rpm seconds.
+	float commonAction;                 // Action shared by both wheels.
+	float differentialAction;           // Action added to the first wheel and taken from the second.
+
+	float commonKf;                     // Common action per rpm of target.
+	float commonKp;                     // Gains on the errors, which are measured less target, so usually negative like PID.Kp.
+	float commonKi;
+	float differentialKp;
+	float differentialKi;
+
+	bool ready;                         // Whether both wheels have settled at their targets and match each other.
+	unsigned long delay;
+	TaskHandle task;                    // Handle to the controlling task.
+	Semaphore wake;                     // Given to wake the controlling task early.
+}
+DualFlywheel;
+
+typedef struct DualFlywheelSetup
+{
+	FlywheelSetup wheels[2];            // Sensors, motors and estimator settings of each wheel. Their controller settings are unused.
+	float commonKf;                     // Common action per rpm of target, about the inverse of the plant gain.
+	float commonKp;
+	float commonKi;
+	float differentialKp;
+	float differentialKi;
+}
+DualFlywheelSetup;
+
+// Returns NULL if either wheel's sensor couldn't be added to the sensor hub, or memory ran out.
+DualFlywheel *dualFlywheelInit(DualFlywheelSetup setup);
+
+void dualFlywheelRun(DualFlywheel *dual);
+
+// Sets the mean target rpm of the wheels.
+void dualFlywheelSet(DualFlywheel *dual, float rpm);
+
+// Sets how much faster, in rpm, the first wheel should spin than the second.
+void dualFlywheelSetSpin(DualFlywheel *dual, float rpm);
+
+// Whether both wheels are at speed and matched.
+bool dualFlywheelIsReady(DualFlywheel *dual);
+
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+// End include guard
+#endif
@@ -3,6 +3,9 @@
 
 #include <API.h>
 #include <stdbool.h>
+#include "motors.h"
+#include "sensor-hub.h"
+#include "utils.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -10,54 +13,108 @@ extern "C" {
 
 
 
+#define FLYWHEEL_APPROX_NODES 16                // Number of targets, evenly spaced from zero, that first-crossing actions are learnt for.
+
 typedef enum ControllerType
 {
 	CONTROLLER_TYPE_PID,
 	CONTROLLER_TYPE_TBH,
-	CONTROLLER_TYPE_BANG_BANG
+	CONTROLLER_TYPE_BANG_BANG,
+	CONTROLLER_TYPE_STATE_SPACE,        // Integral state feedback with LQR gains from tools/lqr-gains.py.
+	CONTROLLER_TYPE_MPC                 // Explicit model predictive control, from the table made by tools/mpc-table.py.
 }
 ControllerType;
 
+typedef enum FlywheelSensor
+{
+	FLYWHEEL_SENSOR_ENCODER,            // Quadrature encoder on two digital ports.
+	FLYWHEEL_SENSOR_IME                 // Integrated motor encoder's velocity, read over I2C.
+}
+FlywheelSensor;
+
 typedef struct Flywheel		// TODO: look at packing and alignment
 {
 
-	float target;                       // Target speed in rpm.
+	float target;                       // Target speed in rpm, as followed by the controller.
+	float commandedTarget;              // Target speed in rpm that was last set; the target is profiled towards it.
+	float targetRate;                   // Rate, in rpm per second, that the target is currently changing at.
 	float measured;                     // Measured speed in rpm.
 	float measuredRaw;
 	float derivative;                   // Rate at which the measured speed had changed.
-	float integral;
+	float errorIntegral;                // Integral of the error sampled since the last controller update, in rpm seconds.
+	float stepErrorIntegral;            // Integral of the error over the last controller update interval, in rpm seconds.
+	float integral;                     // Integral of the error, in rpm seconds, for the integrating controllers.
 	float error;                        // Difference in the target and the measured speed in rpm.
 	float action;                       // Controller output sent to the (smart) motors.
+	float actionMinimum;                // Lowest action the controller may output.
+	float actionMaximum;                // Highest action the controller may output.
+	float limitMinimum;                 // Lowest action in effect: the minimum, narrowed to where the capped motor output saturates.
+	float limitMaximum;                 // Highest action in effect, narrowed the same way.
+	float feedforward;                  // Action added to the controller's to cancel the estimated load, and boost for shots.
+	float appliedAction;                // Action actually applied: the controller's action plus the feedforward, limited.
+	float load;                         // Estimated deceleration, in rpm per second, caused by load beyond the plant model.
 
 	float lastAction;
 	float lastError;
 	bool firstCross;
 
 	int reading;                        // Previous encoder value.
-	unsigned long microTime;            // The time in microseconds of the last update.
+	unsigned long microTime;            // The time in microseconds of the last encoder sample.
+	unsigned long controlMicroTime;     // The time in microseconds of the last controller update.
 	float timeChange;                   // The time difference between updates, in seconds.
 
 	float pidKp;                         // Gain proportional constant for integrating controller.
 	float pidKi;
 	float pidKd;
 	float tbhGain;
-	float tbhApprox;
+	float tbhApprox;                    // Action jumped to on the first zero crossing, for targets without a learnt action.
+	float approxSpacing;                // Target rpm between each node of the learnt first-crossing actions.
+	float approxNodes[FLYWHEEL_APPROX_NODES]; // Steady state action learnt at each node's target.
+	unsigned int approxLearntMask;      // Bit set for each node that has been learnt.
+	bool approxLearning;                // Whether the steady state action is learnt while ready.
+	bool approxChanged;                 // Whether a learnt action has moved past the save threshold since it was last saved.
+	float approxSavedNodes[FLYWHEEL_APPROX_NODES]; // Learnt actions as last saved or loaded.
+	unsigned int approxSavedMask;       // Learnt mask as last saved or loaded.
+	bool approxSaveDue;                 // Whether a save may still be tried in this disabled period.
 	float bangBangValue;
+	float profileAcceleration;          // Fastest the target may change, in rpm per second. Zero applies target changes as steps.
+	float profileJerk;                  // Fastest the target's rate of change may change, in rpm per second squared. Zero gives a trapezoidal profile.
+	float plantGain;                    // Steady state rpm per unit of action, for the disturbance observer.
+	float plantTimeConstant;            // Time constant, in seconds, of the flywheel's speed response. Zero disables the disturbance observer, and jam detection's acceleration check.
+	float observerSmoothing;            // Low-pass filter time constant, in seconds, of the load estimate.
+	float observerGain;                 // Fraction of the estimated load fed forward, from 0 to 1.
+	float shotBoost;                    // Action added for a short time when a shot is about to be fired.
+	LowPassGain observerFilter;         // Cached gain of the load estimate's low-pass filter.
+	unsigned long shotMicroTime;        // The time in microseconds a shot was last signalled.
+	bool shotImminent;                  // Whether the output is being boosted for a shot.
+	unsigned long stallMicroTime;       // The time in microseconds the flywheel started to look stalled, or zero if it doesn't.
+	unsigned long jamMicroTime;         // The time in microseconds the output was last cut for a jam.
+	unsigned long jamOffTime;           // Time in microseconds the output stays cut for, doubling with each jam in a row; zero if not in a row.
+	unsigned int jamCount;              // Number of jams detected.
+	bool jammed;                        // Whether the output is cut because the flywheel is jammed.
 	float gearing;                      // Ratio of flywheel RPM per encoder RPM.
 	float encoderTicksPerRevolution;    // Number of ticks each time the encoder completes one revolution
+	float imeVelocityDivisor;           // Number of IME internal rpm per motor output rpm.
+	bool imeReverse;                    // Whether the IME velocity readings are negated.
 	float smoothing;                    // Amount of smoothing applied to the flywheel RPM, which is the low-pass filter time constant in seconds.
 
+	LowPassGain filter;                 // Cached step gain of the speed's low-pass filter.
+
 	bool ready;                         // Whether the controller is in ready mode (true, flywheel at the right speed) or active mode (false), which affects task priority and update rate.
 	unsigned long delay;
 	bool allowReadify;
+	bool batteryCompensate;             // Whether the motor outputs are scaled up as the battery voltage sags.
 
 	ControllerType controllerType;
 
 	Mutex targetMutex;                  // Mutex for updating the target speed.
 	TaskHandle task;                    // Handle to the controlling task.
-	Encoder encoder;                    // Encoder used to measure the rpm.
-	unsigned char motorChannels[4];
-	bool motorReversed[4];
+	Semaphore wake;                     // Given to wake the controlling task early, when the flywheel needs to be active.
+	FlywheelSensor sensor;              // Kind of sensor used to measure the rpm.
+	Encoder encoder;                    // Encoder used to measure the rpm, if the sensor is a quadrature encoder.
+	int encoderSensor;                  // Index of the encoder or IME reading in the sensor hub snapshots.
+	MotorGroup motors;                  // Motor channels driving the flywheel.
+	MotorType motorType;                // Type of the motors, which decides how their output is linearized.
 }
 Flywheel;
 
@@ -68,22 +125,57 @@ typedef struct FlywheelSetup
 	float pidKi;
 	float pidKd;
 	float tbhGain;
-	float tbhApprox;
+	float tbhApprox;                    // Action jumped to on the first zero crossing, for targets without a learnt action.
+	float approxSpacing;                // Target rpm between each node of the learnt first-crossing actions. Zero disables learning.
 	float bangBangValue;
+	float profileAcceleration;          // Fastest the target may change, in rpm per second. Zero applies target changes as steps.
+	float profileJerk;                  // Fastest the target's rate of change may change, in rpm per second squared. Zero gives a trapezoidal profile.
+	float actionMinimum;                // Lowest action the controller may output. If both limits are left at zero, -127 to 127 is used.
+	float actionMaximum;                // Highest action the controller may output.
+	float plantGain;                    // Steady state rpm per unit of action, for the disturbance observer.
+	float plantTimeConstant;            // Time constant, in seconds, of the flywheel's speed response. Zero disables the disturbance observer, and jam detection's acceleration check.
+	float observerSmoothing;            // Low-pass filter time constant, in seconds, of the load estimate.
+	float observerGain;                 // Fraction of the estimated load fed forward, from 0 to 1.
+	float shotBoost;                    // Action added for a short time when a shot is about to be fired.
 	float smoothing;                    // Amount of smoothing applied to the flywheel RPM, as the low-pass time constant in seconds.
 	float encoderTicksPerRevolution;    // Number of ticks each time the encoder completes one revolution
+	float imeVelocityDivisor;           // Number of IME internal rpm per motor output rpm, one of the IME_VELOCITY_DIVISOR constants.
+	FlywheelSensor sensor;              // Kind of sensor used to measure the rpm; the encoder by default.
+	unsigned char imeAddress;           // Address of the IME on the I2C chain, if the sensor is an IME.
 	unsigned char encoderPortTop;       // Digital port number where the encoder's top wire is connected.
 	unsigned char encoderPortBottom;    // Digital port number where the encoder's bottom wire is connected. 
 	unsigned char motorChannels[4];
-	bool encoderReverse;                // Whether the encoder values should be reversed.
+	bool encoderReverse;                // Whether the encoder values, or the IME's, should be reversed.
 	bool motorReversed[4];
+	MotorType motorType;                // Type of the motors, which decides how their output is linearized.
+	bool batteryCompensate;             // Whether the motor outputs are scaled up as the battery voltage sags.
 }
 FlywheelSetup;
 
+//
+// Returns NULL if the sensor hub has no room for the flywheel's sensor.
+//
 Flywheel *flywheelInit(FlywheelSetup setup);
 
 void flywheelRun(Flywheel *flywheel);
 
+// Runs only the estimator on the sensor hub, for a flywheel that is controlled by something else,
+// such as a DualFlywheel. Don't also call flywheelRun.
+void flywheelRunEstimator(Flywheel *flywheel);
+
+// Returns the error integrated by the estimator since the last call, in rpm seconds.
+float flywheelTakeErrorIntegral(Flywheel *flywheel);
+
+// Applies an action from an outside controller, with the feedforward, linearization and battery
+// compensation. The motors are only queued; call motorsFlush afterwards.
+void flywheelApply(Flywheel *flywheel, float action);
+
+// Whether the measured speed has settled at the target.
+bool flywheelIsSettled(Flywheel *flywheel);
+
+// Whether the output is cut because the flywheel is jammed.
+bool flywheelIsJammed(Flywheel *flywheel);
+
 // Sets target RPM
 void flywheelSet(Flywheel *flywheel, float rpm);
 
@@ -94,7 +186,25 @@ void flywheelSetPidKi(Flywheel *flywheel, float gain);
 void flywheelSetPidKd(Flywheel *flywheel, float gain);
 void flywheelSetTbhGain(Flywheel *flywheel, float gain);
 void flywheelSetTbhApprox(Flywheel *flywheel, float approx);
+void flywheelSetProfileAcceleration(Flywheel *flywheel, float acceleration);
+void flywheelSetProfileJerk(Flywheel *flywheel, float jerk);
+void flywheelSetActionMinimum(Flywheel *flywheel, float minimum);
+void flywheelSetActionMaximum(Flywheel *flywheel, float maximum);
+void flywheelSetPlantGain(Flywheel *flywheel, float gain);
+void flywheelSetPlantTimeConstant(Flywheel *flywheel, float timeConstant);
+void flywheelSetObserverGain(Flywheel *flywheel, float gain);
+void flywheelSetShotBoost(Flywheel *flywheel, float boost);
 void flywheelSetAllowReadify(Flywheel *flywheel, bool isAllowed);
+void flywheelSetBatteryCompensate(Flywheel *flywheel, bool isCompensated);
+void flywheelSetMotorType(Flywheel *flywheel, MotorType type);
+void flywheelSetApproxLearning(Flywheel *flywheel, bool isLearning);
+
+// Hints that a ball is about to hit the flywheel, so the output is boosted ahead of the dip.
+void flywheelShotImminent(Flywheel *flywheel);
+
+// Writes the learnt first-crossing actions to flash if they have changed. Only call while the motors are stopped.
+// Returns false if the file could not be written, e.g. as another file is open for writing.
+bool flywheelSaveApprox(Flywheel *flywheel);
 
 // End C++ export structure
 #ifdef __cplusplus
@@ -0,0 +1,36 @@
+#ifndef FRAME_SYNC_H_
+#define FRAME_SYNC_H_
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//
+// Starts estimating when the master processor exchanges motor and joystick data,
+// by watching for the joystick and battery readings it sends to change.
+//
+void frameSyncRun();
+
+//
+// Returns how many milliseconds to wait so that the caller wakes the given number of
+// microseconds before the master frame nearest to periodMs from now. Motor values set
+// then go out on that frame, and joystick values read then are the freshest.
+// Returns periodMs unchanged until the frame timing has been worked out.
+//
+unsigned long frameSyncDelay(unsigned long periodMs, unsigned long leadMicros);
+
+//
+// Delays until the given number of microseconds before the master frame nearest to periodMs from now.
+//
+void frameSyncWait(unsigned long periodMs, unsigned long leadMicros);
+
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+// End include guard
+#endif
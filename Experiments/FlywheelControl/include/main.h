@@ -113,6 +113,12 @@ void initialize();
  */
 void operatorControl();
 
+//
+// Streams the flywheel's state over stdout for the controls program to log.
+//
+void streamOutTask(void *args);
+
+// NULL if the flywheel couldn't be set up; everything that uses it checks first.
 extern Flywheel *flywheel;
 //Flywheel *flywheel = NULL;
 
@@ -0,0 +1,127 @@
+#ifndef MECHANISM_H_
+#define MECHANISM_H_
+
+#include <API.h>
+#include <stdbool.h>
+#include "motors.h"
+#include "utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define MECHANISM_MAX 8                         // Most mechanisms that can be added.
+
+typedef enum MechanismMode
+{
+	MECHANISM_MODE_OFF,                 // Output held at zero.
+	MECHANISM_MODE_OPEN_LOOP,           // The target is the action itself.
+	MECHANISM_MODE_VELOCITY,            // The target is a velocity, in units per second.
+	MECHANISM_MODE_POSITION             // The target is a position, in units.
+}
+MechanismMode;
+
+//
+// A motor group closed around one sensor, such as a lift, an intake or a side of the drive.
+// Like the flywheel, errors are measured less target, so the feedback gains are usually negative.
+//
+typedef struct Mechanism
+{
+	MechanismMode mode;                 // Mode in effect, taken from the latest request on each tick.
+	float target;                       // Position, velocity or action, depending on the mode.
+	float position;                     // Measured position, in units.
+	float velocity;                     // Filtered velocity, in units per second.
+	float error;                        // Measured position or velocity less the target.
+	float integral;                     // Integral of the error.
+	float action;                       // Output, from -127 to 127, proportional to speed.
+
+	float kf;                           // Action per unit of target velocity, in velocity mode.
+	float kp;
+	float ki;
+	float kd;                           // Action per unit per second of velocity, in position mode.
+	float actionMinimum;
+	float actionMaximum;
+	float limitMinimum;                 // Lowest action in effect: the minimum, narrowed to where the capped motor output saturates.
+	float limitMaximum;                 // Highest action in effect, narrowed the same way.
+	float slewRate;                     // Fastest the action may change, per second. Zero leaves it unlimited.
+	float smoothing;                    // Low-pass filter time constant, in seconds, of the velocity.
+	float freeSpeed;                    // Unloaded velocity at full action, for the thermal model. Zero if unknown.
+
+	// Mode and target requested by mechanismSet, published together like the sensor hub's snapshots.
+	volatile unsigned long requestSequence; // Counts up with each request; zero while one is being written.
+	volatile MechanismMode requestMode;
+	volatile float requestTarget;
+	unsigned long requestCount;         // Requests written, by the setting task.
+	unsigned long appliedSequence;      // Sequence of the request in effect, by the hub task.
+
+	int sensor;                         // Index of the position reading in the sensor hub snapshots.
+	float unitsPerTick;                 // Units of position per sensor tick.
+	int reading;                        // Previous sensor reading.
+	unsigned long microTime;            // The time in microseconds of the previous reading.
+	bool sampled;                       // Whether there is a previous reading.
+	LowPassGain filter;                 // Cached gain of the velocity filter.
+
+	MotorGroup motors;
+	MotorType motorType;
+	bool batteryCompensate;             // Whether the motor outputs are scaled up as the battery voltage sags.
+}
+Mechanism;
+
+typedef struct MechanismSetup
+{
+	int sensor;                         // Index returned by one of the sensorHubAdd functions.
+	float unitsPerTick;                 // Units of position per sensor tick, e.g. degrees or inches.
+	float smoothing;                    // Low-pass filter time constant, in seconds, of the velocity.
+	float kf;
+	float kp;
+	float ki;
+	float kd;
+	float actionMinimum;                // If both limits are left at zero, -127 to 127 is used.
+	float actionMaximum;
+	float slewRate;                     // Fastest the action may change, per second. Zero leaves it unlimited.
+	float freeSpeed;                    // Unloaded velocity at full action, for the thermal model. Zero if unknown.
+	unsigned char motorChannels[4];     // Zero-terminated.
+	bool motorReversed[4];
+	MotorType motorType;
+	bool batteryCompensate;
+}
+MechanismSetup;
+
+//
+// Adds a mechanism to be updated on every sensor hub tick, starting in the off mode.
+// Call from initialize(). Returns NULL if there are already MECHANISM_MAX, or if the sensor
+// is -1, as returned when the sensor hub was full.
+//
+Mechanism *mechanismAdd(MechanismSetup setup);
+
+//
+// Starts updating every mechanism, in one pass, after each sensor hub tick.
+//
+void mechanismsRun();
+
+//
+// Changes the mode and target together, from the next tick on, clearing the integral if the mode changed.
+// The mode and target are never seen apart. Only set a mechanism from one task at a time.
+//
+void mechanismSet(Mechanism *mechanism, MechanismMode mode, float target);
+
+//
+// Changes the target, keeping the mode last set.
+//
+void mechanismSetTarget(Mechanism *mechanism, float target);
+
+//
+// Whether the error is within the tolerance and the mechanism is barely moving, in position mode,
+// or just whether the error is within the tolerance, in velocity mode.
+//
+bool mechanismIsSettled(Mechanism *mechanism, float tolerance);
+
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+// End include guard
+#endif
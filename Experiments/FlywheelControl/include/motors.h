@@ -0,0 +1,82 @@
+#ifndef MOTORS_H_
+#define MOTORS_H_
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//
+// Kinds of motor, each with its own curve from motor command to speed.
+//
+typedef enum MotorType
+{
+	MOTOR_TYPE_LINEAR,                  // Commands are sent as is, with no linearization.
+	MOTOR_TYPE_393                      // VEX 2-wire motor 393, in any internal gearing.
+}
+MotorType;
+
+//
+// Converts a command that is proportional to the motor's speed, from -127 to 127,
+// to the value to send to motorSet for the given type of motor.
+//
+int motorLinearize(MotorType type, float command);
+
+//
+// Converts a value sent to motorSet back to the smallest command that motorLinearize turns
+// into at least that value, so that a controller can tell where its output saturates.
+//
+float motorDelinearize(MotorType type, int value);
+
+//
+// A set of motor channels that are driven together, with the reversed
+// channels kept as a precomputed sign mask.
+//
+typedef struct MotorGroup
+{
+	unsigned short channelMask;         // Bit n is set if channel n is in the group.
+	unsigned short reversedMask;        // Bit n is set if channel n is reversed.
+}
+MotorGroup;
+
+//
+// Makes a group from a zero-terminated list of at most count channels.
+//
+MotorGroup motorGroupInit(const unsigned char *channels, const bool *reversed, int count);
+
+//
+// Queues a value for every channel in the group, reversing where needed.
+// Nothing is sent to the motors until motorsFlush is called.
+//
+void motorGroupSet(const MotorGroup *group, int value);
+
+//
+// Queues a value for a single channel.
+// Nothing is sent to the motors until motorsFlush is called.
+//
+void motorsSet(unsigned char channel, int value);
+
+//
+// Sends, in one pass, every queued value that differs from what its channel was last sent.
+// Values are capped by the thermal model first, where a PTC is near tripping.
+// Safe to call from several tasks, as the flush, and the thermal model's update, are done under a lock;
+// each call only sends what has changed.
+//
+void motorsFlush();
+
+//
+// Number of motorSet calls made, and number skipped because the value had not changed.
+//
+unsigned long motorsWriteCount();
+unsigned long motorsSkipCount();
+
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+// End include guard
+#endif
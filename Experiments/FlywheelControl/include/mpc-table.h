@@ -0,0 +1,30 @@
+#ifndef MPC_TABLE_H_
+#define MPC_TABLE_H_
+
+// Generated by tools/mpc-table.py; regenerate rather than edit.
+// Plant from state-space-gains.h: 13.5285 rpm per action, 0.693976 s time constant; horizon 10 x 5 updates of 0.02 s.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MPC_TABLE_LOAD_NODES 5                  // Number of estimated loads in the table.
+#define MPC_TABLE_TARGET_NODES 17               // Number of targets in the table.
+#define MPC_TABLE_ERROR_NODES 49                // Number of speed errors in the table.
+#define MPC_TABLE_TARGET_SPACING 107.382302f    // Rpm between each target node, from zero.
+#define MPC_TABLE_ERROR_MINIMUM -600.000000f    // Speed error, measured minus target, of the first error node.
+#define MPC_TABLE_ERROR_SPACING 25.000000f      // Rpm between each error node.
+#define MPC_TABLE_LOAD_SPACING 250.000000f      // Rpm per second between each load node, from zero.
+
+//
+// Optimal first actions, indexed [load][target][error].
+//
+extern const signed char mpcTable[MPC_TABLE_LOAD_NODES][MPC_TABLE_TARGET_NODES][MPC_TABLE_ERROR_NODES];
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+// End include guard
+#endif
@@ -0,0 +1,71 @@
+#ifndef ODOMETRY_H_
+#define ODOMETRY_H_
+
+#include <API.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define ODOMETRY_DISTANCE_SCALE 1024            // Pose distance units per inch.
+#define ODOMETRY_ANGLE_SCALE 65536              // Pose angle units per revolution.
+
+//
+// Where the robot is, in fixed point. The x axis points forward from where the pose was last reset
+// to zero, the y axis to the left, and the heading is counter-clockwise from the x axis.
+//
+typedef struct OdometryPose
+{
+	unsigned long sequence;             // Counts up with each update; zero while the pose is being written.
+	unsigned long microTime;            // The time in microseconds the sensors were sampled.
+	int x;                              // In 1/ODOMETRY_DISTANCE_SCALE inches.
+	int y;
+	int heading;                        // In 1/ODOMETRY_ANGLE_SCALE revolutions, counting whole turns.
+}
+OdometryPose;
+
+typedef struct OdometrySetup
+{
+	int leftSensor;                     // Sensor hub index of the left drive encoder, counting up going forward.
+	int rightSensor;                    // Sensor hub index of the right drive encoder, counting up going forward.
+	int gyroSensor;                     // Sensor hub index of the gyro, or -1 for the encoders alone.
+	bool gyroReverse;                   // Whether the gyro counts up turning clockwise.
+	float inchesPerTick;                // Distance a wheel travels per encoder tick.
+	float trackWidth;                   // Effective distance, in inches, between the left and right wheels.
+}
+OdometrySetup;
+
+//
+// Starts tracking the pose on every sensor hub tick. Encoder heading changes are fused with the gyro,
+// which corrects their slip and scrub, while the encoders fill in between the gyro's whole degrees.
+//
+void odometryRun(OdometrySetup setup);
+
+//
+// Copies the latest pose, without taking any locks.
+// Returns false, with a zero pose, if none has been worked out yet.
+//
+bool odometryRead(OdometryPose *pose);
+
+//
+// Moves the pose, in inches and degrees, from the next tick on.
+// Only reset from one task at a time.
+//
+void odometryReset(float x, float y, float heading);
+
+//
+// Converts pose units to inches and degrees.
+//
+float odometryInches(int distance);
+float odometryDegrees(int angle);
+
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+// End include guard
+#endif
@@ -0,0 +1,84 @@
+#ifndef ROUTINE_H_
+#define ROUTINE_H_
+
+#include <API.h>
+#include <stdbool.h>
+#include "flywheel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define ROUTINE_MAX_SIZE 512                    // Most bytes of bytecode in a routine.
+
+//
+// Autonomous routines, compiled on the host by tools/routine-compiler.py into bytecode that is kept
+// on the file system, so routines can be changed without reflashing. Each instruction is an opcode
+// byte followed by its operands, little endian:
+//
+//   END                                          Ends the routine, or a branch.
+//   DRIVE      short tenths of inches, byte in/s Drives straight, holding the heading.
+//   TURN       short tenths of degrees, byte in/s Turns on the spot, counter-clockwise positive.
+//   FLYWHEEL   unsigned short rpm                Sets the flywheel target.
+//   WAIT_READY unsigned short milliseconds       Waits for the flywheel to be ready, or the timeout if not zero.
+//   FIRE       byte count                        Fires balls, and waits for them to be fed.
+//   WAIT       unsigned short milliseconds       Waits.
+//   PARALLEL   byte branches                     Runs branches together, and waits for all of them.
+//              Each branch is an unsigned short length, then that many bytes ending in END.
+//
+typedef enum RoutineOpcode
+{
+	ROUTINE_OP_END,
+	ROUTINE_OP_DRIVE,
+	ROUTINE_OP_TURN,
+	ROUTINE_OP_FLYWHEEL,
+	ROUTINE_OP_WAIT_READY,
+	ROUTINE_OP_FIRE,
+	ROUTINE_OP_WAIT,
+	ROUTINE_OP_PARALLEL,
+	ROUTINE_OP_COUNT
+}
+RoutineOpcode;
+
+//
+// Loads the saved routine and starts it from the beginning. Returns false if there is no valid routine
+// or the drive could not be set up.
+//
+bool routineStart(Flywheel *flywheel);
+
+//
+// Runs every instruction that can make progress, without blocking. Call once per tick.
+// Returns false once the routine has ended.
+//
+bool routineStep();
+
+//
+// Blocks until the sensor hub's next tick, so that each step sees fresh drive and odometry readings.
+// Call between steps of a started routine.
+//
+void routineWait();
+
+//
+// Ends the routine, stopping the drive and cancelling any queued balls.
+//
+void routineStop();
+
+//
+// Builds a routine to save in pieces, as it is uploaded over the serial link.
+// Saving is given the length and CRC-16/CCITT (0x1021, starting from 0xFFFF) the compiler
+// printed, and refuses a routine that doesn't match them, so a dropped or garbled piece is
+// never saved. It writes to flash, so it is also refused unless the robot is disabled.
+//
+void routineClear();
+bool routineAppend(const unsigned char *bytes, int count);
+bool routineSave(int length, unsigned int crc);
+
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+// End include guard
+#endif
@@ -0,0 +1,95 @@
+#ifndef SENSOR_HUB_H_
+#define SENSOR_HUB_H_
+
+#include <API.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define SENSOR_HUB_MAX_SENSORS 16               // Most sensors that can be registered.
+#define SENSOR_HUB_MAX_LISTENERS 8              // Most listeners that can be registered.
+#define SENSOR_HUB_DELAY 5                      // Time in milliseconds between samples of every sensor.
+
+//
+// Readings of every registered sensor, all taken in the same tick.
+//
+typedef struct SensorSnapshot
+{
+	unsigned long sequence;             // Counts up with each tick; zero while the snapshot is being written.
+	unsigned long microTime;            // The time in microseconds the sensors were sampled.
+	int values[SENSOR_HUB_MAX_SENSORS]; // Readings, indexed by the number returned when the sensor was added.
+}
+SensorSnapshot;
+
+//
+// Called from the hub task after each new snapshot is published. Must return quickly.
+//
+typedef void (*SensorListener)(const SensorSnapshot *snapshot, void *context);
+
+//
+// Registers a sensor to be sampled every tick.
+// Each returns the index of its reading in the snapshot values, or -1 if the hub is full.
+//
+int sensorHubAddEncoder(Encoder encoder);
+int sensorHubAddAnalog(unsigned char channel);
+int sensorHubAddDigital(unsigned char pin);
+int sensorHubAddJoystickAxis(unsigned char joystick, unsigned char axis);
+
+//
+// Registers an integrated motor encoder, by its address on the I2C chain, to be read every tick.
+// All IMEs are read together in one sweep, so the control loops never wait on the I2C bus.
+// The chain is initialized the first time an IME is added, so add them from initialize().
+// If a read fails, the previous reading is kept.
+//
+int sensorHubAddImeCount(unsigned char address);
+int sensorHubAddImeVelocity(unsigned char address);
+
+//
+// Registers an analog channel that is oversampled in the background by the analog input task,
+// which this starts. The reading is the filtered value, at 16 times the 12-bit resolution,
+// less the zero taken when added if calibrate is set.
+//
+int sensorHubAddAnalogOversampled(unsigned char channel, bool calibrate);
+
+//
+// Registers an ultrasonic sensor, which the kernel pings in the background.
+// The reading is the last distance in centimeters, or zero if nothing echoed.
+//
+int sensorHubAddUltrasonic(Ultrasonic ultrasonic);
+
+//
+// Registers a gyro. The reading is the cumulative angle in degrees, rounded to the nearest degree.
+//
+int sensorHubAddGyro(Gyro gyro);
+
+//
+// Registers a function to be called after every tick. Returns false if the hub is full.
+//
+bool sensorHubListen(SensorListener listener, void *context);
+
+//
+// Starts the task that samples the sensors, if it is not already running.
+//
+void sensorHubRun();
+
+//
+// Copies the latest complete snapshot, without taking any locks.
+//
+void sensorHubRead(SensorSnapshot *snapshot);
+
+//
+// Returns the latest reading of a single sensor, without taking any locks.
+//
+int sensorHubGet(int sensor);
+
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+// End include guard
+#endif
@@ -0,0 +1,78 @@
+#ifndef SHOOTER_H_
+#define SHOOTER_H_
+
+#include <API.h>
+#include <stdbool.h>
+#include "flywheel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct ShooterSetup
+{
+	unsigned char feederChannels[2];    // Motor channels driving the feeder, zero-terminated.
+	bool feederReversed[2];
+	int feedPower;                      // Motor value while feeding a ball.
+	unsigned long feedTime;             // Time in microseconds the feeder runs for each ball.
+	unsigned long transportDelay;       // Time in microseconds from starting the feeder to the ball reaching the flywheel.
+	float readyError;                   // The +/- rpm the flywheel may be off its target when a ball reaches it.
+}
+ShooterSetup;
+
+//
+// Timing of one shot, for tuning the transport delay.
+//
+typedef struct ShotRecord
+{
+	unsigned int number;                // Counts up from one with each shot.
+	unsigned long requestTime;          // The time in microseconds the shot was next in line.
+	unsigned long feedTime;             // The time in microseconds the feeder was started.
+	unsigned long arrivalTime;          // The time in microseconds the ball was expected to reach the flywheel.
+	float arrivalError;                 // Flywheel error, in rpm, when the ball was expected to reach it.
+}
+ShotRecord;
+
+//
+// Starts sequencing shots from the sensor hub's ticks. Each ball is fed as soon as the flywheel is
+// predicted to be within the ready error by the time the ball reaches it, rather than once it is ready.
+// Balls still queued when the robot is disabled are dropped.
+//
+void shooterRun(Flywheel *flywheel, ShooterSetup setup);
+
+//
+// Queues balls to be fired.
+//
+void shooterFire(unsigned int count);
+
+//
+// Drops any queued balls, stopping the feeder if it is running.
+//
+void shooterCancel();
+
+//
+// Returns the number of balls queued or being fed.
+//
+unsigned int shooterPending();
+
+//
+// Returns the predicted time, in seconds, until the flywheel is within the ready error,
+// or a negative number if it isn't getting any closer.
+//
+float shooterTimeToReady();
+
+//
+// Takes the oldest shot record not yet taken. Returns false if there are none.
+// Only the most recent few are kept.
+//
+bool shooterNextRecord(ShotRecord *record);
+
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+// End include guard
+#endif
@@ -0,0 +1,17 @@
+#ifndef STATE_SPACE_GAINS_H_
+#define STATE_SPACE_GAINS_H_
+
+// Generated by tools/lqr-gains.py; regenerate rather than edit.
+// Plant identified from 2015-07-19.5.csv; weights: error 50 rpm, integral 10 rpm s, action 127.
+
+// The log predates output linearization, so these gains assume the action is sent to the
+// motors as is: run the flywheel with MOTOR_TYPE_LINEAR until they are re-identified
+// from a log recorded with linearization on.
+
+#define STATE_SPACE_PLANT_GAIN 13.528479f       // Steady state rpm per unit of action.
+#define STATE_SPACE_TIME_CONSTANT 0.693976f     // Time constant of the speed response, in seconds.
+#define STATE_SPACE_PERIOD 0.020000f            // Update period, in seconds, the gains were calculated for.
+#define STATE_SPACE_ERROR_GAIN 1.692530f        // Action per rpm of error.
+#define STATE_SPACE_INTEGRAL_GAIN 7.625596f     // Action per rpm second of error integral.
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef THERMAL_H_
+#define THERMAL_H_
+
+#include <stdbool.h>
+#include "motors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//
+// Estimates how close each motor's PTC, and each of the Cortex's two port bank PTCs, is to
+// tripping, and works out how far to cap each channel's output to keep them from tripping.
+// The banks are shared by every mechanism plugged into them, so a bank near its limit cuts
+// the channels with the largest weight the most.
+//
+
+//
+// Updates the estimates from the values last sent to each channel, indexed by channel from 1 to 10,
+// or NULL if the motors are stopped. Only updates at a low rate; other calls return straight away.
+//
+void thermalUpdate(const short *values);
+
+//
+// Returns the fraction, from 0 to 1, of full output that a channel's output is capped at.
+//
+float thermalScale(unsigned char channel);
+
+//
+// Returns the lowest cap of any channel in the group, so that its controller can keep its action
+// within what the motors will actually be sent, rather than winding up against the cap.
+//
+float thermalGroupScale(const MotorGroup *group);
+
+//
+// Sets the group's speed, as the fraction of full output that would spin it that fast unloaded.
+// The faster a motor spins for the same output, the less current it draws; channels default
+// to zero, the stalled worst case.
+//
+void thermalSetSpeed(const MotorGroup *group, float fraction);
+
+//
+// Sets how much of a bank's cut the group takes, relative to the other channels in the bank.
+// Channels default to one; zero exempts a group from bank cuts, though not its own motors' limits.
+//
+void thermalSetWeight(const MotorGroup *group, float weight);
+
+//
+// Returns the estimated heat in a channel's motor PTC, or in a bank's PTC (0 for ports 1-5,
+// 1 for ports 6-10), as a fraction of what trips it.
+//
+float thermalMotorLoad(unsigned char channel);
+float thermalBankLoad(int bank);
+
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+// End include guard
+#endif
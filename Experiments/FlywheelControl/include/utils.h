@@ -17,6 +17,28 @@ float timeUpdate(unsigned long *microTime);
 
 int signOf(int x);
 
+//
+// Limits the value to lie between the minimum and the maximum.
+//
+float clamp(float value, float minimum, float maximum);
+
+//
+// Cached gain of an exactly discretized low-pass filter, 1 - exp(-timeChange / smoothing).
+//
+typedef struct LowPassGain
+{
+	float gain;
+	float timeChange;                   // Time change, in seconds, the gain was calculated for.
+	float smoothing;                    // Time constant, in seconds, the gain was calculated for.
+}
+LowPassGain;
+
+//
+// Returns the low-pass filter gain for the time change and smoothing,
+// only recalculating it when either has changed since the last call.
+//
+float lowPassGain(LowPassGain *cache, float timeChange, float smoothing);
+
 float stringToFloat(const char* string);
 
 bool stringStartsWith(char const *pre, char const *string);
@@ -35,6 +57,13 @@ int stringCaseInsensitiveCompare(char const *a, char const *b, size_t maxCount);
 #define TICKS_PER_REVOLUTION_MOTOR_393_STANDARD (float)(627.2f)
 #define TICKS_PER_REVOLUTION_QUADRATURE (float)(360.0f)
 
+// Internal encoder wheel rpm per output rpm, for converting imeGetVelocity readings.
+
+#define IME_VELOCITY_DIVISOR_MOTOR_269 (float)(30.056f)
+#define IME_VELOCITY_DIVISOR_MOTOR_393_SPEED (float)(24.5f)
+#define IME_VELOCITY_DIVISOR_MOTOR_393_STANDARD (float)(39.2f)
+#define IME_VELOCITY_DIVISOR_MOTOR_393_TURBO (float)(16.3333f)
+
 
 // End C++ export structure
 #ifdef __cplusplus
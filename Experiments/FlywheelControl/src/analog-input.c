@@ -0,0 +1,136 @@
+#include "analog-input.h"
+
+#include <API.h>
+
+
+
+
+#define ANALOG_INPUT_OVERSAMPLING 16            // Number of raw samples summed into each decimated sample, giving 16 times the resolution.
+#define ANALOG_INPUT_AVERAGE_LENGTH 4           // Number of decimated samples averaged into each published reading.
+
+#define ANALOG_INPUT_PRIORITY 3                 // Priority of the sampling task.
+#define ANALOG_INPUT_DELAY 1                    // Delay, in milliseconds, between samples of each channel.
+
+
+
+
+typedef struct AnalogChannel
+{
+	unsigned char channel;
+	int offset;                         // Calibrated zero, at 16 times the 12-bit value.
+	int accumulator;                    // Sum of the raw samples taken towards the next decimated sample.
+	int history[ANALOG_INPUT_AVERAGE_LENGTH];   // Latest decimated samples.
+	int historySum;                     // Sum of the history.
+	unsigned char historyIndex;         // Position in the history to write next.
+}
+AnalogChannel;
+
+
+
+
+AnalogChannel analogInputChannels[BOARD_NR_ADC_PINS];
+int analogInputChannelCount = 0;
+unsigned int analogInputSampleCount = 0;
+volatile int analogInputValues[BOARD_NR_ADC_PINS + 1];  // Published readings, indexed by channel.
+TaskHandle analogInputTask = NULL;
+
+
+
+
+// Private functions, forward declarations.
+
+void analogInputSampleTask(void *args);
+void analogInputSample();
+void analogInputDecimate(AnalogChannel *channel);
+
+
+
+bool analogInputAdd(unsigned char channel, bool calibrate)
+{
+	if (analogInputChannelCount >= BOARD_NR_ADC_PINS || channel < 1 || channel > BOARD_NR_ADC_PINS)
+	{
+		return false;
+	}
+
+	AnalogChannel *added = &analogInputChannels[analogInputChannelCount];
+	added->channel = channel;
+	added->offset = calibrate? analogCalibrate(channel) * ANALOG_INPUT_OVERSAMPLING : 0;
+	added->accumulator = 0;
+
+	// Start the filter settled on the current reading, rather than ramping up from zero.
+	int initial = analogRead(channel) * ANALOG_INPUT_OVERSAMPLING;
+	for (int i = 0; i < ANALOG_INPUT_AVERAGE_LENGTH; i++)
+	{
+		added->history[i] = initial;
+	}
+	added->historySum = initial * ANALOG_INPUT_AVERAGE_LENGTH;
+	added->historyIndex = 0;
+	analogInputValues[channel] = initial - added->offset;
+
+	++analogInputChannelCount;
+	return true;
+}
+
+
+void analogInputRun()
+{
+	if (!analogInputTask && analogInputChannelCount > 0)
+	{
+		analogInputTask = taskCreate(analogInputSampleTask, TASK_MINIMAL_STACK_SIZE * 2, NULL, ANALOG_INPUT_PRIORITY);
+	}
+}
+
+
+int analogInputGet(unsigned char channel)
+{
+	return analogInputValues[channel];
+}
+
+
+void analogInputSampleTask(void *args)
+{
+	unsigned long wakeTime = millis();
+	while (1)
+	{
+		analogInputSample();
+		taskDelayUntil(&wakeTime, ANALOG_INPUT_DELAY);
+	}
+}
+
+
+// Takes one raw sample of every channel in turn, decimating once enough have been summed.
+void analogInputSample()
+{
+	bool decimate = ++analogInputSampleCount >= ANALOG_INPUT_OVERSAMPLING;
+	if (decimate)
+	{
+		analogInputSampleCount = 0;
+	}
+
+	for (int i = 0; i < analogInputChannelCount; i++)
+	{
+		AnalogChannel *channel = &analogInputChannels[i];
+		channel->accumulator += analogRead(channel->channel);
+		if (decimate)
+		{
+			analogInputDecimate(channel);
+		}
+	}
+}
+
+
+// Moves the summed samples into the moving average, and publishes the result.
+void analogInputDecimate(AnalogChannel *channel)
+{
+	int sample = channel->accumulator;
+	channel->accumulator = 0;
+
+	channel->historySum += sample - channel->history[channel->historyIndex];
+	channel->history[channel->historyIndex] = sample;
+	if (++channel->historyIndex >= ANALOG_INPUT_AVERAGE_LENGTH)
+	{
+		channel->historyIndex = 0;
+	}
+
+	analogInputValues[channel->channel] = channel->historySum / ANALOG_INPUT_AVERAGE_LENGTH - channel->offset;
+}
@@ -33,6 +33,7 @@
  */
 
 #include "main.h"
+#include "routine.h"
 
 /*
  * Runs the user autonomous code. This function will be started in its own task with the default
@@ -48,5 +49,15 @@
  * The autonomous task may exit, unlike operatorControl() which should never exit. If it does
  * so, the robot will await a switch to another mode or disable/enable cycle.
  */
-void autonomous() {
+void autonomous()
+{
+	if (!flywheel || !routineStart(flywheel))
+	{
+		return;
+	}
+	while (routineStep())
+	{
+		routineWait();
+	}
+	routineStop();
 }
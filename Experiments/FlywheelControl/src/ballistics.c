@@ -0,0 +1,247 @@
+#include "ballistics.h"
+
+#include <API.h>
+#include "sensor-hub.h"
+#include "utils.h"
+
+
+
+
+#define BALLISTICS_SMOOTHING 0.3f               // Low-pass filter time constant, in seconds, applied to the distance.
+#define BALLISTICS_HYSTERESIS 15.0f             // Rpm the table's target has to move by before the flywheel is given it.
+#define BALLISTICS_FILE "ballist"               // Flash file the calibration table is kept in; at most eight characters.
+#define BALLISTICS_FILE_VERSION 1               // Written first in the file, so an incompatible file is ignored.
+#define BALLISTICS_POINT_TOLERANCE 1.0f         // Centimeters within which a new calibration point replaces an old one.
+
+
+
+
+// Starting points for calibration, in centimeters and rpm.
+const float ballisticsDefaultDistances[] = { 60.0f, 120.0f, 180.0f, 240.0f, 300.0f };
+const float ballisticsDefaultRpms[] = { 900.0f, 1100.0f, 1300.0f, 1450.0f, 1600.0f };
+
+float ballisticsDistances[BALLISTICS_MAX_POINTS];       // Calibration distances, in increasing order.
+float ballisticsRpms[BALLISTICS_MAX_POINTS];
+int ballisticsPointCount = 0;
+Mutex ballisticsMutex = NULL;                           // Guards the table against calibration while it's being read.
+
+Flywheel *ballisticsFlywheel = NULL;
+int ballisticsSensor = -1;
+float ballisticsFilteredDistance = 0.0f;
+float ballisticsSetRpm = 0.0f;                          // Target last given to the flywheel.
+unsigned long ballisticsMicroTime = 0;
+LowPassGain ballisticsFilter = { 0.0f, 0.0f, -1.0f };
+bool ballisticsActive = true;
+
+
+
+
+// Private functions, forward declarations.
+
+void ballisticsSample(const SensorSnapshot *snapshot, void *context);
+float ballisticsInterpolate(float distance);
+void ballisticsLoad();
+
+
+
+bool ballisticsRun(Flywheel *flywheel, unsigned char portEcho, unsigned char portPing)
+{
+	if (ballisticsFlywheel)
+	{
+		return true;
+	}
+	ballisticsMutex = mutexCreate();
+	ballisticsLoad();
+	ballisticsFlywheel = flywheel;
+	ballisticsSensor = sensorHubAddUltrasonic(ultrasonicInit(portEcho, portPing));
+	// The table can still be calibrated and saved, but nothing follows the distance.
+	if (ballisticsSensor < 0 || !sensorHubListen(ballisticsSample, NULL))
+	{
+		return false;
+	}
+	ballisticsMicroTime = micros();
+	sensorHubRun();
+	return true;
+}
+
+
+void ballisticsSetActive(bool isActive)
+{
+	ballisticsActive = isActive;
+	// Give the flywheel the current target straight away once resumed.
+	ballisticsSetRpm = -BALLISTICS_HYSTERESIS;
+}
+
+
+float ballisticsDistance()
+{
+	return ballisticsFilteredDistance;
+}
+
+
+float ballisticsRpm(float distance)
+{
+	mutexTake(ballisticsMutex, -1);
+	float rpm = ballisticsInterpolate(distance);
+	mutexGive(ballisticsMutex);
+	return rpm;
+}
+
+
+bool ballisticsSetPoint(float distance, float rpm)
+{
+	mutexTake(ballisticsMutex, -1);
+	int i = 0;
+	while (i < ballisticsPointCount && ballisticsDistances[i] < distance - BALLISTICS_POINT_TOLERANCE)
+	{
+		++i;
+	}
+	bool isReplacing = i < ballisticsPointCount && ballisticsDistances[i] <= distance + BALLISTICS_POINT_TOLERANCE;
+	if (!isReplacing)
+	{
+		if (ballisticsPointCount >= BALLISTICS_MAX_POINTS)
+		{
+			mutexGive(ballisticsMutex);
+			return false;
+		}
+		for (int j = ballisticsPointCount; j > i; --j)
+		{
+			ballisticsDistances[j] = ballisticsDistances[j - 1];
+			ballisticsRpms[j] = ballisticsRpms[j - 1];
+		}
+		++ballisticsPointCount;
+	}
+	ballisticsDistances[i] = distance;
+	ballisticsRpms[i] = rpm;
+	mutexGive(ballisticsMutex);
+	return true;
+}
+
+
+void ballisticsClear()
+{
+	mutexTake(ballisticsMutex, -1);
+	ballisticsPointCount = 0;
+	mutexGive(ballisticsMutex);
+}
+
+
+bool ballisticsSave()
+{
+	// Flash should only be written with the actuators stopped.
+	if (isEnabled())
+	{
+		return false;
+	}
+	FILE *file = fopen(BALLISTICS_FILE, "w");
+	if (!file)
+	{
+		return false;
+	}
+	mutexTake(ballisticsMutex, -1);
+	unsigned int version = BALLISTICS_FILE_VERSION;
+	int count = ballisticsPointCount;
+	bool isWritten = fwrite(&version, sizeof(version), 1, file) == 1
+		&& fwrite(&count, sizeof(count), 1, file) == 1
+		&& fwrite(ballisticsDistances, sizeof(ballisticsDistances[0]), count, file) == (size_t)count
+		&& fwrite(ballisticsRpms, sizeof(ballisticsRpms[0]), count, file) == (size_t)count;
+	mutexGive(ballisticsMutex);
+	fclose(file);
+	return isWritten;
+}
+
+
+
+void ballisticsSample(const SensorSnapshot *snapshot, void *context)
+{
+	float timeChange = (snapshot->microTime - ballisticsMicroTime) / 1000000.0f;
+	ballisticsMicroTime = snapshot->microTime;
+
+	// Zero means nothing echoed; keep the last distance rather than pulling it towards zero.
+	int distance = snapshot->values[ballisticsSensor];
+	if (distance <= 0)
+	{
+		return;
+	}
+	if (ballisticsFilteredDistance <= 0.0f)
+	{
+		ballisticsFilteredDistance = distance;
+	}
+	ballisticsFilteredDistance += (distance - ballisticsFilteredDistance) * lowPassGain(&ballisticsFilter, timeChange, BALLISTICS_SMOOTHING);
+
+	// Calibration is rare, so skip a tick rather than block the hub if it's underway.
+	if (!ballisticsActive || !mutexTake(ballisticsMutex, 0))
+	{
+		return;
+	}
+	// A table cleared for recalibration keeps the last target, rather than stopping the flywheel.
+	bool isEmpty = ballisticsPointCount == 0;
+	float rpm = ballisticsInterpolate(ballisticsFilteredDistance);
+	mutexGive(ballisticsMutex);
+	if (isEmpty)
+	{
+		return;
+	}
+
+	if (rpm - ballisticsSetRpm > BALLISTICS_HYSTERESIS || ballisticsSetRpm - rpm > BALLISTICS_HYSTERESIS)
+	{
+		ballisticsSetRpm = rpm;
+		flywheelSet(ballisticsFlywheel, rpm);
+	}
+}
+
+
+// Linear interpolation in the table, holding the end points beyond its range.
+float ballisticsInterpolate(float distance)
+{
+	if (ballisticsPointCount == 0)
+	{
+		return 0.0f;
+	}
+	if (distance <= ballisticsDistances[0])
+	{
+		return ballisticsRpms[0];
+	}
+	int i = 1;
+	while (i < ballisticsPointCount && ballisticsDistances[i] < distance)
+	{
+		++i;
+	}
+	if (i == ballisticsPointCount)
+	{
+		return ballisticsRpms[i - 1];
+	}
+	float weight = (distance - ballisticsDistances[i - 1]) / (ballisticsDistances[i] - ballisticsDistances[i - 1]);
+	return ballisticsRpms[i - 1] + weight * (ballisticsRpms[i] - ballisticsRpms[i - 1]);
+}
+
+
+void ballisticsLoad()
+{
+	FILE *file = fopen(BALLISTICS_FILE, "r");
+	if (file)
+	{
+		unsigned int version = 0;
+		int count = 0;
+		bool isRead = fread(&version, sizeof(version), 1, file) == 1
+			&& version == BALLISTICS_FILE_VERSION
+			&& fread(&count, sizeof(count), 1, file) == 1
+			&& 0 < count && count <= BALLISTICS_MAX_POINTS
+			&& fread(ballisticsDistances, sizeof(ballisticsDistances[0]), count, file) == (size_t)count
+			&& fread(ballisticsRpms, sizeof(ballisticsRpms[0]), count, file) == (size_t)count;
+		fclose(file);
+		if (isRead)
+		{
+			ballisticsPointCount = count;
+			return;
+		}
+	}
+
+	int count = sizeof(ballisticsDefaultDistances) / sizeof(ballisticsDefaultDistances[0]);
+	for (int i = 0; i < count; i++)
+	{
+		ballisticsDistances[i] = ballisticsDefaultDistances[i];
+		ballisticsRpms[i] = ballisticsDefaultRpms[i];
+	}
+	ballisticsPointCount = count;
+}
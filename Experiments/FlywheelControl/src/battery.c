@@ -0,0 +1,89 @@
+#include "battery.h"
+
+#include <API.h>
+#include <math.h>
+#include "utils.h"
+
+
+
+
+#define BATTERY_NOMINAL_VOLTAGE 7.2f            // Voltage, in volts, that motor outputs are scaled to behave like.
+#define BATTERY_MINIMUM_VOLTAGE 5.5f            // Below this voltage, in volts, the reading is distrusted (e.g. running from USB) and outputs are left alone.
+#define BATTERY_MAXIMUM_COMPENSATION 1.5f       // Largest factor that outputs are scaled by.
+#define BATTERY_SMOOTHING 1.0f                  // Low-pass filter time constant, in seconds, applied to the voltage.
+#define BATTERY_SAMPLE_PERIOD 100000            // Time in microseconds between battery samples.
+
+
+
+
+float batteryFilteredVoltage = 0.0f;
+float batteryCachedCompensation = 1.0f;
+unsigned long batteryMicroTime = 0;
+bool batteryPolled = false;                     // Whether the battery has been read, sane or not.
+bool batterySampled = false;                    // Whether a sane reading has been filtered in.
+
+
+
+
+// Private functions, forward declarations.
+
+void batteryUpdate();
+
+
+
+float batteryVoltage()
+{
+	batteryUpdate();
+	return batteryFilteredVoltage;
+}
+
+
+float batteryCompensation()
+{
+	batteryUpdate();
+	return batteryCachedCompensation;
+}
+
+
+void batteryUpdate()
+{
+	if (batteryPolled && micros() - batteryMicroTime < BATTERY_SAMPLE_PERIOD)
+	{
+		return;
+	}
+
+	float voltage = powerLevelMain() / 1000.0f;
+	float timeChange = timeUpdate(&batteryMicroTime);
+	batteryPolled = true;
+
+	// A reading this low is a brownout, an unplugged battery or USB power, not a sagging battery;
+	// leave it out of the filter, and the outputs alone until the readings are sane again.
+	if (voltage < BATTERY_MINIMUM_VOLTAGE)
+	{
+		batteryCachedCompensation = 1.0f;
+		return;
+	}
+
+	if (batterySampled)
+	{
+		batteryFilteredVoltage += (voltage - batteryFilteredVoltage) * (1.0f - expf(-timeChange / BATTERY_SMOOTHING));
+	}
+	else
+	{
+		batteryFilteredVoltage = voltage;
+		batterySampled = true;
+	}
+
+	if (batteryFilteredVoltage < BATTERY_MINIMUM_VOLTAGE)
+	{
+		batteryCachedCompensation = 1.0f;
+	}
+	else
+	{
+		batteryCachedCompensation = BATTERY_NOMINAL_VOLTAGE / batteryFilteredVoltage;
+		if (batteryCachedCompensation > BATTERY_MAXIMUM_COMPENSATION)
+		{
+			batteryCachedCompensation = BATTERY_MAXIMUM_COMPENSATION;
+		}
+	}
+}
@@ -7,7 +7,10 @@
 #include <string.h>
 #include <ctype.h>
 
+#include "ballistics.h"
 #include "flywheel.h"
+#include "routine.h"
+#include "shooter.h"
 #include "utils.h"
 
 typedef void(*Handler)(char const *);
@@ -26,6 +29,16 @@ HandlerMap;
 void stdinHandler();
 void handleRequest(const HandlerMap *api, const size_t apiSize, char const *request);
 void handleSet(char const *request);
+void handleFire(char const *request);
+void handleRoutine(char const *request);
+void handleBallistics(char const *request);
+void handleBallisticsPoint(char const *request);
+void handleBallisticsClear(char const *request);
+void handleBallisticsSave(char const *request);
+void handleBallisticsActive(char const *request);
+int hexDigitValue(char digit);
+char const *splitWord(char const *request, char *word, size_t size);
+bool isWord(char const *word, char const *request);
 void handleSetFlywheelFloat(char const *request, FlywheelFloatAcceptor accept);
 void handleSetFlywheelBool(char const *request, FlywheelBoolAcceptor accept);
 void handleSetTarget(char const *request);
@@ -36,16 +49,40 @@ void handleSetPidKi(char const *request);
 void handleSetPidKd(char const *request);
 void handleSetTbhGain(char const *request);
 void handleSetTbhApprox(char const *request);
+void handleSetProfileAcceleration(char const *request);
+void handleSetProfileJerk(char const *request);
+void handleSetActionMinimum(char const *request);
+void handleSetActionMaximum(char const *request);
+void handleSetPlantGain(char const *request);
+void handleSetPlantTimeConstant(char const *request);
+void handleSetObserverGain(char const *request);
+void handleSetShotBoost(char const *request);
 void handleSetAllowReadify(char const *request);
+void handleSetApproxLearning(char const *request);
+void handleSetBatteryCompensate(char const *request);
+void handleSetMotorType(char const *request);
 
-HandlerMap methods[1] =
+HandlerMap methods[4] =
 {
-	{ "Set", handleSet }
+	{ "Set", handleSet },
+	{ "Fire", handleFire },
+	{ "Routine", handleRoutine },
+	{ "Ballistics", handleBallistics }
 };
 
-#define METHODS_API_SIZE 1
+#define METHODS_API_SIZE 4
 
-HandlerMap setters[9] =
+HandlerMap ballisticsMethods[4] =
+{
+	{ "point", handleBallisticsPoint },
+	{ "clear", handleBallisticsClear },
+	{ "save", handleBallisticsSave },
+	{ "active", handleBallisticsActive }
+};
+
+#define BALLISTICS_API_SIZE 4
+
+HandlerMap setters[20] =
 {
 	{ "target", handleSetTarget },
 	{ "controller", handleSetController },
@@ -55,10 +92,21 @@ HandlerMap setters[9] =
 	{ "PID.Kd", handleSetPidKd },
 	{ "TBH.gain", handleSetTbhGain },
 	{ "TBH.approx", handleSetTbhApprox },
-	{ "allow-readify", handleSetAllowReadify }
+	{ "TBH.learn", handleSetApproxLearning },
+	{ "profile.accel", handleSetProfileAcceleration },
+	{ "profile.jerk", handleSetProfileJerk },
+	{ "action.min", handleSetActionMinimum },
+	{ "action.max", handleSetActionMaximum },
+	{ "plant.gain", handleSetPlantGain },
+	{ "plant.tau", handleSetPlantTimeConstant },
+	{ "observer.gain", handleSetObserverGain },
+	{ "shot.boost", handleSetShotBoost },
+	{ "allow-readify", handleSetAllowReadify },
+	{ "battery-comp", handleSetBatteryCompensate },
+	{ "motor-type", handleSetMotorType }
 };
 
-#define SETTERS_API_SIZE 9
+#define SETTERS_API_SIZE 20
 
 
 
@@ -118,9 +166,143 @@ void handleSet(char const *request)
 	handleRequest(setters, SETTERS_API_SIZE, request);
 }
 
+void handleFire(char const *request)
+{
+	float count = stringToFloat(request);
+	if (count > 0.0f)
+	{
+		shooterFire((unsigned int)count);
+	}
+	else
+	{
+		shooterCancel();
+	}
+}
+
+
+// Uploads an autonomous routine in pieces, as printed by tools/routine-compiler.py.
+void handleRoutine(char const *request)
+{
+	if (isWord("clear", request))
+	{
+		routineClear();
+		return;
+	}
+	if (isWord("save", request))
+	{
+		// Followed by the length and CRC, to check that every piece arrived intact.
+		char length[16];
+		char const *crc = splitWord(request + 4, length, sizeof(length));
+		bool isSaved = crc && routineSave((int)stringToFloat(length), (unsigned int)stringToFloat(crc));
+		printf(isSaved? "Routine saved\n" : "Routine not saved; disable the robot, and upload it again\n");
+		return;
+	}
+	unsigned char bytes[64];
+	int count = 0;
+	while (count < 64 && isxdigit((unsigned char)request[0]) && isxdigit((unsigned char)request[1]))
+	{
+		bytes[count++] = hexDigitValue(request[0]) << 4 | hexDigitValue(request[1]);
+		request += 2;
+	}
+	if (!routineAppend(bytes, count))
+	{
+		printf("Routine too long\n");
+	}
+}
+
+
+void handleBallistics(char const *request)
+{
+	// Ballistics only runs alongside the flywheel it sets.
+	if (!flywheel)
+	{
+		return;
+	}
+	handleRequest(ballisticsMethods, BALLISTICS_API_SIZE, request);
+}
+
+// Adds a calibration point, given as the distance in centimeters then the rpm.
+void handleBallisticsPoint(char const *request)
+{
+	char distance[16];
+	char const *rpm = splitWord(request, distance, sizeof(distance));
+	if (rpm && !ballisticsSetPoint(stringToFloat(distance), stringToFloat(rpm)))
+	{
+		printf("Ballistics table full\n");
+	}
+}
+
+void handleBallisticsClear(char const *request)
+{
+	ballisticsClear();
+}
+
+void handleBallisticsSave(char const *request)
+{
+	printf(ballisticsSave()? "Ballistics saved\n" : "Ballistics not saved; disable the robot\n");
+}
+
+void handleBallisticsActive(char const *request)
+{
+	if (stringStartsWith("true", request))
+	{
+		ballisticsSetActive(true);
+	}
+	else if (stringStartsWith("false", request))
+	{
+		ballisticsSetActive(false);
+	}
+}
+
+
+int hexDigitValue(char digit)
+{
+	if (isdigit((unsigned char)digit))
+	{
+		return digit - '0';
+	}
+	return tolower((unsigned char)digit) - 'a' + 10;
+}
+
+
+// Copies the first word of the request, after any spaces, and returns the rest after the spaces
+// that follow it, or NULL if the word is missing, too long, or is the last.
+char const *splitWord(char const *request, char *word, size_t size)
+{
+	while (*request == ' ' || *request == '\t')
+	{
+		++request;
+	}
+	size_t length = strcspn(request, " \t\r\n");
+	if (length == 0 || length >= size)
+	{
+		return NULL;
+	}
+	memcpy(word, request, length);
+	word[length] = '\0';
+	request += length;
+	while (*request == ' ' || *request == '\t')
+	{
+		++request;
+	}
+	return *request && *request != '\r' && *request != '\n'? request : NULL;
+}
+
+
+// Whether the request starts with the whole word, rather than a longer word beginning with it.
+bool isWord(char const *word, char const *request)
+{
+	size_t length = strlen(word);
+	return strncmp(word, request, length) == 0 && (request[length] == '\0' || isspace((unsigned char)request[length]));
+}
+
 
 void handleSetFlywheelFloat(char const *request, FlywheelFloatAcceptor accept)
 {
+	if (!flywheel)
+	{
+		return;
+	}
 	float value = stringToFloat(request);
 	//printf("Debug String to float:\n");
 	//printf("Debug %s --> %f\n", request, value);
@@ -129,6 +311,10 @@ void handleSetFlywheelFloat(char const *request, FlywheelFloatAcceptor accept)
 
 void handleSetFlywheelBool(char const *request, FlywheelBoolAcceptor accept)
 {
+	if (!flywheel)
+	{
+		return;
+	}
 	if (stringStartsWith("true", request))
 	{
 		accept(flywheel, true);
@@ -159,11 +345,22 @@ void handleSetController(char const *request)
 	{
 		controllerType = CONTROLLER_TYPE_BANG_BANG;
 	}
+	else if (stringStartsWith("State-space", request))
+	{
+		controllerType = CONTROLLER_TYPE_STATE_SPACE;
+	}
+	else if (stringStartsWith("MPC", request))
+	{
+		controllerType = CONTROLLER_TYPE_MPC;
+	}
 	else
 	{
 		return;
 	}
-	flywheelSetController(flywheel, controllerType);
+	if (flywheel)
+	{
+		flywheelSetController(flywheel, controllerType);
+	}
 }
 
 void handleSetSmoothing(char const *request)
@@ -196,7 +393,78 @@ void handleSetTbhApprox(char const *request)
 	handleSetFlywheelFloat(request, flywheelSetTbhApprox);
 }
 
+void handleSetProfileAcceleration(char const *request)
+{
+	handleSetFlywheelFloat(request, flywheelSetProfileAcceleration);
+}
+
+void handleSetProfileJerk(char const *request)
+{
+	handleSetFlywheelFloat(request, flywheelSetProfileJerk);
+}
+
+void handleSetActionMinimum(char const *request)
+{
+	handleSetFlywheelFloat(request, flywheelSetActionMinimum);
+}
+
+void handleSetActionMaximum(char const *request)
+{
+	handleSetFlywheelFloat(request, flywheelSetActionMaximum);
+}
+
+void handleSetPlantGain(char const *request)
+{
+	handleSetFlywheelFloat(request, flywheelSetPlantGain);
+}
+
+void handleSetPlantTimeConstant(char const *request)
+{
+	handleSetFlywheelFloat(request, flywheelSetPlantTimeConstant);
+}
+
+void handleSetObserverGain(char const *request)
+{
+	handleSetFlywheelFloat(request, flywheelSetObserverGain);
+}
+
+void handleSetShotBoost(char const *request)
+{
+	handleSetFlywheelFloat(request, flywheelSetShotBoost);
+}
+
 void handleSetAllowReadify(char const *request)
 {
 	handleSetFlywheelBool(request, flywheelSetAllowReadify);
+}
+
+void handleSetApproxLearning(char const *request)
+{
+	handleSetFlywheelBool(request, flywheelSetApproxLearning);
+}
+
+void handleSetBatteryCompensate(char const *request)
+{
+	handleSetFlywheelBool(request, flywheelSetBatteryCompensate);
+}
+
+void handleSetMotorType(char const *request)
+{
+	MotorType motorType;
+	if (stringStartsWith("393", request))
+	{
+		motorType = MOTOR_TYPE_393;
+	}
+	else if (stringStartsWith("Linear", request))
+	{
+		motorType = MOTOR_TYPE_LINEAR;
+	}
+	else
+	{
+		return;
+	}
+	if (flywheel)
+	{
+		flywheelSetMotorType(flywheel, motorType);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include "control.h"
+
+#include <API.h>
+#include <math.h>
+#include "battery.h"
+#include "thermal.h"
+#include "utils.h"
+
+
+
+float controlIntegrate(float *integral, float base, float error, float errorIntegral, float kp, float ki, float minimum, float maximum)
+{
+	float integralChange = ki * errorIntegral;
+	float action = base + kp * error + ki * *integral + integralChange;
+	bool pushingHigher = action > maximum && integralChange > 0.0f;
+	bool pushingLower = action < minimum && integralChange < 0.0f;
+	if (!pushingHigher && !pushingLower)
+	{
+		*integral += errorIntegral;
+	}
+	return clamp(base + kp * error + ki * *integral, minimum, maximum);
+}
+
+
+void controlLimits(const MotorGroup *group, MotorType type, bool batteryCompensate, float minimum, float maximum, float *limitMinimum, float *limitMaximum)
+{
+	float output = 127.0f * thermalGroupScale(group);
+	if (batteryCompensate)
+	{
+		output /= batteryCompensation();
+	}
+	float saturation = motorDelinearize(type, (int)(output + 0.5f));
+	*limitMinimum = minimum > -saturation? minimum : -saturation;
+	*limitMaximum = maximum < saturation? maximum : saturation;
+}
+
+
+void controlOutput(const MotorGroup *group, MotorType type, bool batteryCompensate, float action)
+{
+	float output = motorLinearize(type, action);
+	if (batteryCompensate)
+	{
+		output = clamp(output * batteryCompensation(), -127, 127);
+	}
+	motorGroupSet(group, output);
+}
+
+
+void controlSetSpeed(const MotorGroup *group, MotorType type, float speedAction)
+{
+	thermalSetSpeed(group, motorLinearize(type, clamp(fabsf(speedAction), 0.0f, 127.0f)) / 127.0f);
+}
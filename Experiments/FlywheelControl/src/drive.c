@@ -0,0 +1,118 @@
+#include "drive.h"
+
+#include <API.h>
+#include <stdlib.h>
+#include "sensor-hub.h"
+#include "thermal.h"
+#include "utils.h"
+
+
+
+
+#define DRIVE_PI 3.14159265f                    // Wheel circumference over diameter.
+
+
+
+
+DriveSetup driveSetup;
+Mechanism *driveLeftSide = NULL;
+Mechanism *driveRightSide = NULL;
+
+
+
+
+// Private functions, forward declarations.
+
+Mechanism *driveAddSide(const unsigned char *channels, const bool *reversed, Encoder encoder);
+float driveJoystickSpeed(int value);
+
+
+
+void driveInit(DriveSetup setup)
+{
+	if (driveLeftSide)
+	{
+		return;
+	}
+	driveSetup = setup;
+	Encoder leftEncoder = encoderInit(setup.leftEncoderPortTop, setup.leftEncoderPortBottom, setup.leftEncoderReverse);
+	Encoder rightEncoder = encoderInit(setup.rightEncoderPortTop, setup.rightEncoderPortBottom, setup.rightEncoderReverse);
+	driveLeftSide = driveAddSide(setup.leftChannels, setup.leftReversed, leftEncoder);
+	driveRightSide = driveAddSide(setup.rightChannels, setup.rightReversed, rightEncoder);
+}
+
+
+void driveTank(int left, int right)
+{
+	driveSetSpeeds(driveJoystickSpeed(left), driveJoystickSpeed(right));
+}
+
+
+void driveSetSpeeds(float left, float right)
+{
+	if (!driveLeftSide || !driveRightSide)
+	{
+		return;
+	}
+	mechanismSet(driveLeftSide, MECHANISM_MODE_VELOCITY, left);
+	mechanismSet(driveRightSide, MECHANISM_MODE_VELOCITY, right);
+}
+
+
+Mechanism *driveLeft()
+{
+	return driveLeftSide;
+}
+
+
+Mechanism *driveRight()
+{
+	return driveRightSide;
+}
+
+
+
+Mechanism *driveAddSide(const unsigned char *channels, const bool *reversed, Encoder encoder)
+{
+	MechanismSetup setup =
+	{
+		.sensor = sensorHubAddEncoder(encoder),
+		.unitsPerTick = DRIVE_PI * driveSetup.wheelDiameter / driveSetup.encoderTicksPerRevolution,
+		.smoothing = driveSetup.smoothing,
+		.kf = 127.0f / driveSetup.freeSpeed,
+		.kp = driveSetup.kp,
+		.ki = driveSetup.ki,
+		.kd = 0.0f,
+		.actionMinimum = -127.0f,
+		.actionMaximum = 127.0f,
+		.slewRate = driveSetup.slewRate,
+		.freeSpeed = driveSetup.freeSpeed,
+		.motorType = driveSetup.motorType,
+		.batteryCompensate = driveSetup.batteryCompensate
+	};
+	for (int i = 0; i < 3; i++)
+	{
+		setup.motorChannels[i] = channels[i];
+		setup.motorReversed[i] = reversed[i];
+	}
+	setup.motorChannels[3] = 0;
+
+	Mechanism *side = mechanismAdd(setup);
+	if (side)
+	{
+		thermalSetWeight(&side->motors, driveSetup.thermalWeight);
+	}
+	return side;
+}
+
+
+float driveJoystickSpeed(int value)
+{
+	int magnitude = abs(value) - driveSetup.deadband;
+	if (magnitude <= 0)
+	{
+		return 0.0f;
+	}
+	float fraction = clamp((float)magnitude / (127 - driveSetup.deadband), 0.0f, 1.0f);
+	return (value > 0? fraction : -fraction) * driveSetup.maximumSpeed;
+}
@@ -0,0 +1,242 @@
+#include "dual-flywheel.h"
+
+#include <API.h>
+#include "control.h"
+#include "frame-sync.h"
+#include "motors.h"
+#include "utils.h"
+
+
+
+
+#define DUAL_FLYWHEEL_READY_DIFFERENCE 2.0f     // The +/- interval the differential error needs to lie in to be considered 'ready'.
+#define DUAL_FLYWHEEL_DISTURBANCE_ERROR 20.0f   // The +/- interval any error can stray by while ready before the controller is woken.
+
+#define DUAL_FLYWHEEL_ACTIVE_PRIORITY 3         // Priority of the update task during active mode
+#define DUAL_FLYWHEEL_READY_PRIORITY 2          // Priority of the update task during ready mode
+
+#define DUAL_FLYWHEEL_ACTIVE_DELAY 20           // Delay for each update during active mode
+#define DUAL_FLYWHEEL_READY_DELAY 200           // Delay for each update during ready mode
+#define DUAL_FLYWHEEL_FRAME_LEAD 1000           // Time in microseconds before each master frame to update, so the outputs make that frame
+
+
+
+
+// Private functions, forward declarations.
+
+void dualFlywheelTask(void *dualPointer);
+void dualFlywheelUpdate(DualFlywheel *dual, float timeChange);
+void dualFlywheelSample(const SensorSnapshot *snapshot, void *dualPointer);
+void dualFlywheelCheckReady(DualFlywheel *dual);
+void dualFlywheelActivate(DualFlywheel *dual);
+void dualFlywheelReadify(DualFlywheel *dual);
+
+
+
+DualFlywheel *dualFlywheelInit(DualFlywheelSetup setup)
+{
+	DualFlywheel *dual = malloc(sizeof(DualFlywheel));
+	if (!dual)
+	{
+		return NULL;
+	}
+	dual->wheels[0] = flywheelInit(setup.wheels[0]);
+	dual->wheels[1] = dual->wheels[0]? flywheelInit(setup.wheels[1]) : NULL;
+	if (!dual->wheels[1])
+	{
+		// The first wheel's sensor keeps its place in the hub, which can't remove sensors.
+		if (dual->wheels[0])
+		{
+			if (dual->wheels[0]->encoder)
+			{
+				encoderShutdown(dual->wheels[0]->encoder);
+			}
+			free(dual->wheels[0]);
+		}
+		free(dual);
+		return NULL;
+	}
+
+	dual->target = 0.0f;
+	dual->spin = 0.0f;
+	dual->commonError = 0.0f;
+	dual->differentialError = 0.0f;
+	dual->commonIntegral = 0.0f;
+	dual->differentialIntegral = 0.0f;
+	dual->commonAction = 0.0f;
+	dual->differentialAction = 0.0f;
+
+	dual->commonKf = setup.commonKf;
+	dual->commonKp = setup.commonKp;
+	dual->commonKi = setup.commonKi;
+	dual->differentialKp = setup.differentialKp;
+	dual->differentialKi = setup.differentialKi;
+
+	dual->ready = true;
+	dual->delay = DUAL_FLYWHEEL_READY_DELAY;
+	dual->task = NULL;
+	dual->wake = semaphoreCreate();
+
+	return dual;
+}
+
+void dualFlywheelRun(DualFlywheel *dual)
+{
+	if (!dual->task)
+	{
+		// The wheels' estimators listen first, so the disturbance check sees this tick's errors.
+		flywheelRunEstimator(dual->wheels[0]);
+		flywheelRunEstimator(dual->wheels[1]);
+		sensorHubListen(dualFlywheelSample, dual);
+		dual->task = taskCreate(dualFlywheelTask, TASK_DEFAULT_STACK_SIZE, dual, DUAL_FLYWHEEL_ACTIVE_PRIORITY);
+	}
+}
+
+void dualFlywheelSet(DualFlywheel *dual, float rpm)
+{
+	dual->target = rpm;
+	flywheelSet(dual->wheels[0], rpm + 0.5f * dual->spin);
+	flywheelSet(dual->wheels[1], rpm - 0.5f * dual->spin);
+	dualFlywheelActivate(dual);
+}
+
+void dualFlywheelSetSpin(DualFlywheel *dual, float rpm)
+{
+	dual->spin = rpm;
+	dualFlywheelSet(dual, dual->target);
+}
+
+bool dualFlywheelIsReady(DualFlywheel *dual)
+{
+	return dual->ready;
+}
+
+
+
+void dualFlywheelTask(void *dualPointer)
+{
+	DualFlywheel *dual = dualPointer;
+	unsigned long microTime = micros();
+	while (1)
+	{
+		dualFlywheelUpdate(dual, timeUpdate(&microTime));
+		dualFlywheelCheckReady(dual);
+		// Sleeps until just before a master frame, but wakes early if the sampler sees a disturbance.
+		semaphoreTake(dual->wake, frameSyncDelay(dual->delay, DUAL_FLYWHEEL_FRAME_LEAD));
+	}
+}
+
+
+void dualFlywheelUpdate(DualFlywheel *dual, float timeChange)
+{
+	Flywheel *first = dual->wheels[0];
+	Flywheel *second = dual->wheels[1];
+
+	float firstIntegral = flywheelTakeErrorIntegral(first);
+	float secondIntegral = flywheelTakeErrorIntegral(second);
+
+	// Hold the controller's state while the kernel has the motors stopped, and let the
+	// wheels' estimators know that nothing is being applied, as a single flywheel does.
+	if (!isEnabled())
+	{
+		first->appliedAction = 0.0f;
+		second->appliedAction = 0.0f;
+		return;
+	}
+
+	// Hold both integrals while either wheel is cut for a jam or looks stalled, as a single flywheel
+	// holds its controller's; the other wheel keeps the last actions.
+	bool isStopped = flywheelIsJammed(first) || flywheelIsJammed(second)
+		|| first->stallMicroTime != 0 || second->stallMicroTime != 0;
+	if (isStopped)
+	{
+		flywheelApply(first, dual->commonAction + 0.5f * dual->differentialAction);
+		flywheelApply(second, dual->commonAction - 0.5f * dual->differentialAction);
+		motorsFlush();
+		return;
+	}
+
+	dual->commonError = 0.5f * (first->error + second->error);
+	dual->differentialError = first->error - second->error;
+
+	// Both wheels have to share one output range.
+	float minimum = first->limitMinimum > second->limitMinimum? first->limitMinimum : second->limitMinimum;
+	float maximum = first->limitMaximum < second->limitMaximum? first->limitMaximum : second->limitMaximum;
+
+	// The difference goes first, and the common action gets the headroom left over, so that
+	// a saturated common action never stops the wheels being matched.
+	float range = 0.5f * (maximum - minimum);
+	dual->differentialAction = controlIntegrate(&dual->differentialIntegral, 0.0f,
+		dual->differentialError, firstIntegral - secondIntegral,
+		dual->differentialKp, dual->differentialKi, -range, range);
+	float halfDifference = 0.5f * dual->differentialAction;
+	float headroom = halfDifference < 0.0f? -halfDifference : halfDifference;
+	dual->commonAction = controlIntegrate(&dual->commonIntegral, dual->commonKf * dual->target,
+		dual->commonError, 0.5f * (firstIntegral + secondIntegral),
+		dual->commonKp, dual->commonKi, minimum + headroom, maximum - headroom);
+
+	flywheelApply(first, dual->commonAction + halfDifference);
+	flywheelApply(second, dual->commonAction - halfDifference);
+	motorsFlush();
+}
+
+
+// Wakes the controller as soon as either wheel strays while ready.
+void dualFlywheelSample(const SensorSnapshot *snapshot, void *dualPointer)
+{
+	DualFlywheel *dual = dualPointer;
+	if (!dual->ready)
+	{
+		return;
+	}
+	float firstError = dual->wheels[0]->error;
+	float secondError = dual->wheels[1]->error;
+	float difference = firstError - secondError;
+	if (firstError < -DUAL_FLYWHEEL_DISTURBANCE_ERROR || DUAL_FLYWHEEL_DISTURBANCE_ERROR < firstError
+		|| secondError < -DUAL_FLYWHEEL_DISTURBANCE_ERROR || DUAL_FLYWHEEL_DISTURBANCE_ERROR < secondError
+		|| difference < -DUAL_FLYWHEEL_DISTURBANCE_ERROR || DUAL_FLYWHEEL_DISTURBANCE_ERROR < difference)
+	{
+		dualFlywheelActivate(dual);
+	}
+}
+
+
+void dualFlywheelCheckReady(DualFlywheel *dual)
+{
+	bool differenceReady = -DUAL_FLYWHEEL_READY_DIFFERENCE < dual->differentialError && dual->differentialError < DUAL_FLYWHEEL_READY_DIFFERENCE;
+	bool ready = differenceReady && flywheelIsSettled(dual->wheels[0]) && flywheelIsSettled(dual->wheels[1]);
+
+	if (ready && !dual->ready)
+	{
+		dualFlywheelReadify(dual);
+	}
+	else if (!ready && dual->ready)
+	{
+		dualFlywheelActivate(dual);
+	}
+}
+
+
+// Faster updates, higher priority, signals active.
+void dualFlywheelActivate(DualFlywheel *dual)
+{
+	dual->ready = false;
+	dual->delay = DUAL_FLYWHEEL_ACTIVE_DELAY;
+	if (dual->task)
+	{
+		taskPrioritySet(dual->task, DUAL_FLYWHEEL_ACTIVE_PRIORITY);
+		semaphoreGive(dual->wake);
+	}
+}
+
+
+// Slower updates, lower priority, signals ready.
+void dualFlywheelReadify(DualFlywheel *dual)
+{
+	dual->ready = true;
+	dual->delay = DUAL_FLYWHEEL_READY_DELAY;
+	if (dual->task)
+	{
+		taskPrioritySet(dual->task, DUAL_FLYWHEEL_READY_PRIORITY);
+	}
+}
@@ -1,6 +1,12 @@
 #include "flywheel.h"
 
 #include <API.h>
+#include <math.h>
+#include <string.h>
+#include "control.h"
+#include "frame-sync.h"
+#include "mpc-table.h"
+#include "state-space-gains.h"
 #include "utils.h"
 
 
@@ -11,14 +17,32 @@
 #define FLYWHEEL_READY_ERROR_INTERVAL 1.0f      // The +/- interval for which the error needs to lie to be considered 'ready'.
 #define FLYWHEEL_READY_DERIVATIVE_INTERVAL 1.0f // The +/- interval for which the measured derivative needs to lie to be considered 'ready'.
 
+#define FLYWHEEL_DISTURBANCE_ERROR_INTERVAL 20.0f // The +/- interval the error can stray by while ready before the controller is woken.
+
 #define FLYWHEEL_ACTIVE_PRIORITY 3              // Priority of the update task during active mode
 #define FLYWHEEL_READY_PRIORITY 2               // Priority of the update task during ready mode
 
+#define FLYWHEEL_JAM_ACTION 60.0f               // Smallest action, in magnitude, that should get the flywheel moving.
+#define FLYWHEEL_JAM_SPEED 50.0f                // Speed in rpm below which the flywheel might be stalled.
+#define FLYWHEEL_JAM_ACCELERATION 0.25f         // Fraction of the model's expected acceleration below which the flywheel might be stalled.
+#define FLYWHEEL_JAM_TIME 250000                // Time in microseconds the flywheel has to look stalled for to be jammed.
+#define FLYWHEEL_JAM_OFF_TIME 100000            // Time in microseconds the output is first cut for after a jam.
+#define FLYWHEEL_JAM_MAXIMUM_OFF_TIME 1600000   // Longest time in microseconds the output is cut for after jams in a row.
+
+#define FLYWHEEL_SHOT_BOOST_TIME 150000         // Time in microseconds the output stays boosted after a shot is signalled
+#define FLYWHEEL_FRAME_LEAD 1000                // Time in microseconds before each master frame to update, so the output makes that frame
+
 #define FLYWHEEL_ACTIVE_DELAY 20                // Delay for each update during active mode
 #define FLYWHEEL_READY_DELAY 200                // Delay for each update during ready mode
 
 #define FLYWHEEL_CHECK_READY_PERIOD 20          // Number of updates before rechecking its ready state
 
+#define FLYWHEEL_APPROX_FILE "tbhapprx"         // Flash file the learnt first-crossing actions are kept in; at most eight characters.
+#define FLYWHEEL_APPROX_FILE_VERSION 1          // Written first in the file, so an incompatible file is ignored.
+#define FLYWHEEL_APPROX_LEARN_RATE 0.1f         // Fraction of the difference to the steady state action learnt each ready update.
+#define FLYWHEEL_APPROX_SAVE_THRESHOLD 2.0f     // Action a learnt node must move by, from its saved value, before the file is rewritten.
+
+
 
 
 
@@ -30,13 +54,30 @@
 
 void task(void *flywheelPointer);
 void update(Flywheel *flywheel);
-void measureRpm(Flywheel *flywheel, float timeChange);
+void sample(const SensorSnapshot *snapshot, void *flywheelPointer);
+void profileTarget(Flywheel *flywheel, float timeChange);
+void measureRpm(Flywheel *flywheel, int reading, float timeChange);
+void observeLoad(Flywheel *flywheel, float timeChange);
+void feedforwardUpdate(Flywheel *flywheel);
+float rawRpm(Flywheel *flywheel, int reading, float timeChange);
 void controllerUpdate(Flywheel *flywheel, float timeChange);
 void pidUpdate(Flywheel *flywheel, float timeChange);
 void tbhUpdate(Flywheel *flywheel, float timeChange);
 void bangBangUpdate(Flywheel *flywheel, float timeChange);
+void stateSpaceUpdate(Flywheel *flywheel, float timeChange);
+void mpcUpdate(Flywheel *flywheel, float timeChange);
+int mpcAxis(float value, float minimum, float spacing, int nodes, float *weight);
+float approxAction(Flywheel *flywheel);
+void learnApprox(Flywheel *flywheel);
+bool approxPosition(Flywheel *flywheel, int *node, float *weight);
+bool approxScalable(Flywheel *flywheel, int node);
+void loadApprox(Flywheel *flywheel);
 void updateMotor(Flywheel *flywheel);
+void updateLimits(Flywheel *flywheel);
 void checkReady(Flywheel *flywheel);
+void checkDisturbance(Flywheel *flywheel);
+void checkJam(Flywheel *flywheel, unsigned long microTime);
+bool isStalled(Flywheel *flywheel);
 void activate(Flywheel *flywheel);
 void readify(Flywheel *flywheel);
 
@@ -44,15 +85,61 @@ void readify(Flywheel *flywheel);
 
 Flywheel *flywheelInit(FlywheelSetup setup)
 {
+	// The sensor is registered first, so a full sensor hub fails the init before anything is made.
+	Encoder encoder = NULL;
+	int encoderSensor = -1;
+	switch (setup.sensor)
+	{
+	case FLYWHEEL_SENSOR_ENCODER:
+		encoder = encoderInit(setup.encoderPortTop, setup.encoderPortBottom, setup.encoderReverse);
+		encoderSensor = sensorHubAddEncoder(encoder);
+		break;
+	case FLYWHEEL_SENSOR_IME:
+		encoderSensor = sensorHubAddImeVelocity(setup.imeAddress);
+		break;
+	}
+	if (encoderSensor < 0)
+	{
+		if (encoder)
+		{
+			encoderShutdown(encoder);
+		}
+		return NULL;
+	}
+
 	Flywheel *flywheel = malloc(sizeof(Flywheel));
+	if (!flywheel)
+	{
+		return NULL;
+	}
 
 	flywheel->target = 0.0f;
+	flywheel->commandedTarget = 0.0f;
+	flywheel->targetRate = 0.0f;
 	flywheel->measured = 0.0f;
 	flywheel->measured = 0.0f;
 	flywheel->derivative = 0.0f;
+	flywheel->errorIntegral = 0.0f;
+	flywheel->stepErrorIntegral = 0.0f;
 	flywheel->integral = 0.0f;
 	flywheel->error = 0.0f;
 	flywheel->action = 0.0f;
+	if (setup.actionMinimum == 0.0f && setup.actionMaximum == 0.0f)
+	{
+		flywheel->actionMinimum = -127.0f;
+		flywheel->actionMaximum = 127.0f;
+	}
+	else
+	{
+		flywheel->actionMinimum = setup.actionMinimum;
+		flywheel->actionMaximum = setup.actionMaximum;
+	}
+	flywheel->limitMinimum = flywheel->actionMinimum;
+	flywheel->limitMaximum = flywheel->actionMaximum;
+
+	flywheel->feedforward = 0.0f;
+	flywheel->appliedAction = 0.0f;
+	flywheel->load = 0.0f;
 
 	flywheel->lastAction = 0.0f;
 	flywheel->lastError = 0.0f;
@@ -60,6 +147,7 @@ Flywheel *flywheelInit(FlywheelSetup setup)
 
 	flywheel->reading = 0;
 	flywheel->microTime = micros();
+	flywheel->controlMicroTime = flywheel->microTime;
 	flywheel->timeChange = 0.0f;
 
 	flywheel->pidKp = setup.pidKp;
@@ -67,29 +155,56 @@ Flywheel *flywheelInit(FlywheelSetup setup)
 	flywheel->pidKd = setup.pidKd;
 	flywheel->tbhGain = setup.tbhGain;
 	flywheel->tbhApprox = setup.tbhApprox;
+	flywheel->approxSpacing = setup.approxSpacing;
+	flywheel->approxLearntMask = 0;
+	flywheel->approxLearning = setup.approxSpacing > 0.0f;
+	flywheel->approxChanged = false;
+	flywheel->approxSaveDue = true;
+	loadApprox(flywheel);
+	memcpy(flywheel->approxSavedNodes, flywheel->approxNodes, sizeof(flywheel->approxNodes));
+	flywheel->approxSavedMask = flywheel->approxLearntMask;
 	flywheel->bangBangValue = setup.bangBangValue;
+	flywheel->profileAcceleration = setup.profileAcceleration;
+	flywheel->profileJerk = setup.profileJerk;
+	flywheel->plantGain = setup.plantGain;
+	flywheel->plantTimeConstant = setup.plantTimeConstant;
+	flywheel->observerSmoothing = setup.observerSmoothing;
+	flywheel->observerGain = setup.observerGain;
+	flywheel->shotBoost = setup.shotBoost;
+	flywheel->observerFilter.gain = 0.0f;
+	flywheel->observerFilter.timeChange = 0.0f;
+	flywheel->observerFilter.smoothing = -1.0f;
+	flywheel->shotMicroTime = 0;
+	flywheel->shotImminent = false;
+	flywheel->stallMicroTime = 0;
+	flywheel->jamMicroTime = 0;
+	flywheel->jamOffTime = 0;
+	flywheel->jamCount = 0;
+	flywheel->jammed = false;
 	flywheel->gearing = setup.gearing;
 	flywheel->encoderTicksPerRevolution = setup.encoderTicksPerRevolution;
+	flywheel->imeVelocityDivisor = setup.imeVelocityDivisor;
+	flywheel->imeReverse = setup.encoderReverse;
 	flywheel->smoothing = setup.smoothing;
 
+	flywheel->filter = (LowPassGain){ 0.0f, 0.0f, -1.0f };
+
 	flywheel->ready = true;
 	flywheel->delay = FLYWHEEL_READY_DELAY;
 	flywheel->allowReadify = true;
+	flywheel->batteryCompensate = setup.batteryCompensate;
 
 	flywheel->controllerType = CONTROLLER_TYPE_PID;
 
 	flywheel->targetMutex = mutexCreate();
 	flywheel->task = NULL;
 	//flywheel->task = taskCreate(task, 1000000, flywheel, FLYWHEEL_READY_PRIORITY);	// TODO: What stack size should be set?
-	flywheel->encoder = encoderInit(setup.encoderPortTop, setup.encoderPortBottom, setup.encoderReverse);
-	flywheel->motorChannels[0] = setup.motorChannels[0];
-	flywheel->motorChannels[1] = setup.motorChannels[1];
-	flywheel->motorChannels[2] = setup.motorChannels[2];
-	flywheel->motorChannels[3] = setup.motorChannels[3];
-	flywheel->motorReversed[0] = setup.motorReversed[0];
-	flywheel->motorReversed[1] = setup.motorReversed[1];
-	flywheel->motorReversed[2] = setup.motorReversed[2];
-	flywheel->motorReversed[3] = setup.motorReversed[3];
+	flywheel->wake = semaphoreCreate();
+	flywheel->sensor = setup.sensor;
+	flywheel->encoder = encoder;
+	flywheel->encoderSensor = encoderSensor;
+	flywheel->motors = motorGroupInit(setup.motorChannels, setup.motorReversed, 4);
+	flywheel->motorType = setup.motorType;
 
 	return flywheel;
 }
@@ -98,6 +213,8 @@ Flywheel *flywheelInit(FlywheelSetup setup)
 void flywheelReset(Flywheel *flywheel)
 {
 	flywheel->derivative = 0.0f;
+	flywheel->errorIntegral = 0.0f;
+	flywheel->stepErrorIntegral = 0.0f;
 	flywheel->integral = 0.0f;
 	flywheel->error = 0.0f;
 	flywheel->action = 0.0f;
@@ -105,14 +222,21 @@ void flywheelReset(Flywheel *flywheel)
 	flywheel->lastError = 0.0f;
 	flywheel->firstCross = true;
 	flywheel->reading = 0;
-	encoderReset(flywheel->encoder);
+	if (flywheel->encoder)
+	{
+		encoderReset(flywheel->encoder);
+	}
 }
 
 // Sets target RPM.
 void flywheelSet(Flywheel *flywheel, float rpm)
 {
 	mutexTake(flywheel->targetMutex, -1); // TODO: figure out how long the block time should be.
-	flywheel->target = rpm;
+	flywheel->commandedTarget = rpm;
+	if (flywheel->profileAcceleration <= 0.0f)
+	{
+		flywheel->target = rpm;
+	}
 	mutexGive(flywheel->targetMutex);
 
 	if (flywheel->ready)
@@ -154,20 +278,144 @@ void flywheelSetTbhApprox(Flywheel *flywheel, float approx)
 {
 	flywheel->tbhApprox = approx;
 }
+void flywheelSetProfileAcceleration(Flywheel *flywheel, float acceleration)
+{
+	flywheel->profileAcceleration = acceleration;
+}
+void flywheelSetProfileJerk(Flywheel *flywheel, float jerk)
+{
+	flywheel->profileJerk = jerk;
+}
+void flywheelSetActionMinimum(Flywheel *flywheel, float minimum)
+{
+	flywheel->actionMinimum = minimum;
+}
+void flywheelSetActionMaximum(Flywheel *flywheel, float maximum)
+{
+	flywheel->actionMaximum = maximum;
+}
+void flywheelSetPlantGain(Flywheel *flywheel, float gain)
+{
+	flywheel->plantGain = gain;
+}
+void flywheelSetPlantTimeConstant(Flywheel *flywheel, float timeConstant)
+{
+	flywheel->plantTimeConstant = timeConstant;
+}
+void flywheelSetObserverGain(Flywheel *flywheel, float gain)
+{
+	flywheel->observerGain = gain;
+}
+void flywheelSetShotBoost(Flywheel *flywheel, float boost)
+{
+	flywheel->shotBoost = boost;
+}
+
+void flywheelShotImminent(Flywheel *flywheel)
+{
+	flywheel->shotMicroTime = micros();
+	flywheel->shotImminent = true;
+	activate(flywheel);
+}
+
 void flywheelSetAllowReadify(Flywheel *flywheel, bool isAllowed)
 {
 	flywheel->allowReadify = isAllowed;
 }
+void flywheelSetBatteryCompensate(Flywheel *flywheel, bool isCompensated)
+{
+	flywheel->batteryCompensate = isCompensated;
+}
+void flywheelSetMotorType(Flywheel *flywheel, MotorType type)
+{
+	flywheel->motorType = type;
+}
+void flywheelSetApproxLearning(Flywheel *flywheel, bool isLearning)
+{
+	flywheel->approxLearning = isLearning && flywheel->approxSpacing > 0.0f;
+}
+
+bool flywheelSaveApprox(Flywheel *flywheel)
+{
+	if (!flywheel->approxChanged)
+	{
+		return true;
+	}
+	// Only one file may be open for writing at a time.
+	FILE *file = fopen(FLYWHEEL_APPROX_FILE, "w");
+	if (!file)
+	{
+		printf("Approx not saved; the file could not be opened\n");
+		return false;
+	}
+	unsigned int version = FLYWHEEL_APPROX_FILE_VERSION;
+	bool isWritten = fwrite(&version, sizeof(version), 1, file) == 1
+		&& fwrite(&flywheel->approxSpacing, sizeof(flywheel->approxSpacing), 1, file) == 1
+		&& fwrite(&flywheel->approxLearntMask, sizeof(flywheel->approxLearntMask), 1, file) == 1
+		&& fwrite(flywheel->approxNodes, sizeof(flywheel->approxNodes[0]), FLYWHEEL_APPROX_NODES, file) == FLYWHEEL_APPROX_NODES;
+	fclose(file);
+	if (!isWritten)
+	{
+		printf("Approx not saved; the file could not be written\n");
+		return false;
+	}
+	memcpy(flywheel->approxSavedNodes, flywheel->approxNodes, sizeof(flywheel->approxNodes));
+	flywheel->approxSavedMask = flywheel->approxLearntMask;
+	flywheel->approxChanged = false;
+	return true;
+}
 
 void flywheelRun(Flywheel *flywheel)
 {
 	if (!flywheel->task)
 	{
-		flywheelReset(flywheel);
+		flywheelRunEstimator(flywheel);
 		flywheel->task = taskCreate(task, TASK_DEFAULT_STACK_SIZE, flywheel, FLYWHEEL_ACTIVE_PRIORITY);
 	}
 }
 
+void flywheelRunEstimator(Flywheel *flywheel)
+{
+	flywheelReset(flywheel);
+	flywheel->microTime = micros();
+	flywheel->controlMicroTime = flywheel->microTime;
+	sensorHubListen(sample, flywheel);
+	sensorHubRun();
+}
+
+float flywheelTakeErrorIntegral(Flywheel *flywheel)
+{
+	mutexTake(flywheel->targetMutex, -1);
+	float errorIntegral = flywheel->errorIntegral;
+	flywheel->errorIntegral = 0.0f;
+	mutexGive(flywheel->targetMutex);
+	return errorIntegral;
+}
+
+void flywheelApply(Flywheel *flywheel, float action)
+{
+	flywheel->action = clamp(action, flywheel->limitMinimum, flywheel->limitMaximum);
+	feedforwardUpdate(flywheel);
+	if (flywheel->jammed)
+	{
+		flywheel->appliedAction = 0.0f;
+	}
+	updateMotor(flywheel);
+}
+
+bool flywheelIsJammed(Flywheel *flywheel)
+{
+	return flywheel->jammed;
+}
+
+bool flywheelIsSettled(Flywheel *flywheel)
+{
+	bool errorReady = -FLYWHEEL_READY_ERROR_INTERVAL < flywheel->error && flywheel->error < FLYWHEEL_READY_ERROR_INTERVAL;
+	bool derivativeReady = -FLYWHEEL_READY_DERIVATIVE_INTERVAL < flywheel->derivative && flywheel->derivative < FLYWHEEL_READY_DERIVATIVE_INTERVAL;
+	bool profileReady = flywheel->target == flywheel->commandedTarget;
+	return errorReady && derivativeReady && profileReady;
+}
+
 
 
 void task(void *flywheelPointer)
@@ -180,7 +428,8 @@ void task(void *flywheelPointer)
 		while (i)
 		{
 			update(flywheel);
-			delay(flywheel->delay);
+			// Sleeps until just before a master frame, but wakes early if the sampler sees a disturbance.
+			semaphoreTake(flywheel->wake, frameSyncDelay(flywheel->delay, FLYWHEEL_FRAME_LEAD));
 			--i;
 		}
 		checkReady(flywheel);
@@ -190,38 +439,191 @@ void task(void *flywheelPointer)
 
 void update(Flywheel *flywheel)
 {
-	float timeChange = timeUpdate(&flywheel->microTime);
-	measureRpm(flywheel, timeChange);
+	float timeChange = timeUpdate(&flywheel->controlMicroTime);
+
+	// Take the error integrated by the sampler since the last update.
+	flywheel->stepErrorIntegral = flywheelTakeErrorIntegral(flywheel);
+
+	// The kernel stops the motors while disabled, e.g. between autonomous and driver control.
+	// Hold the controller's state instead of winding it up, so it carries on once re-enabled.
+	if (!isEnabled())
+	{
+		flywheel->appliedAction = 0.0f;
+		// Flash should only be written with the actuators stopped, and each rewrite uses up space
+		// that is only reclaimed on a power cycle, so try at most once per disabled period.
+		if (flywheel->approxSaveDue)
+		{
+			flywheel->approxSaveDue = false;
+			flywheelSaveApprox(flywheel);
+		}
+		return;
+	}
+	flywheel->approxSaveDue = true;
+
+	// Hold the controller's state while the output is cut for a jam, as while disabled.
+	if (flywheel->jammed)
+	{
+		flywheel->appliedAction = 0.0f;
+		updateMotor(flywheel);
+		motorsFlush();
+		return;
+	}
+
+	if (flywheel->ready)
+	{
+		learnApprox(flywheel);
+	}
 	controllerUpdate(flywheel, timeChange);
+	feedforwardUpdate(flywheel);
 	updateMotor(flywheel);
+	motorsFlush();
 	// TODO: update smart motor group.
 }
 
 
-void measureRpm(Flywheel *flywheel, float timeChange)
+// Runs the estimator on every sensor hub tick, independent of the controller's update rate.
+void sample(const SensorSnapshot *snapshot, void *flywheelPointer)
 {
-	int reading = encoderGet(flywheel->encoder);
-	int ticks = reading - flywheel->reading;
+	Flywheel *flywheel = flywheelPointer;
+	long elapsed = (long)(snapshot->microTime - flywheel->microTime);
+	flywheel->microTime = snapshot->microTime;
+	// The time is seeded from micros(), which can be later than the first snapshot this gets.
+	// Take that snapshot as the starting point rather than a step of a wrapped-around length.
+	if (elapsed <= 0)
+	{
+		flywheel->reading = snapshot->values[flywheel->encoderSensor];
+		return;
+	}
+	float timeChange = elapsed / 1000000.0f;
+	profileTarget(flywheel, timeChange);
+	measureRpm(flywheel, snapshot->values[flywheel->encoderSensor], timeChange);
+	observeLoad(flywheel, timeChange);
+	updateLimits(flywheel);
+	checkJam(flywheel, snapshot->microTime);
+	checkDisturbance(flywheel);
+}
 
-	// Raw rpm
-	float rpm = ticks / flywheel->encoderTicksPerRevolution * flywheel->gearing / timeChange * 60;
 
-	// Low-pass filter
-	float measureChange = (rpm - flywheel->measured) * timeChange / flywheel->smoothing;
+// Moves the target towards the commanded target, limiting its acceleration (and jerk, if set),
+// so the flywheel is spun up as fast as the motors allow without the controller overshooting.
+void profileTarget(Flywheel *flywheel, float timeChange)
+{
+	float acceleration = flywheel->profileAcceleration;
+	float jerk = flywheel->profileJerk;
+
+	mutexTake(flywheel->targetMutex, -1);
+	float remaining = flywheel->commandedTarget - flywheel->target;
+	if (remaining == 0.0f || acceleration <= 0.0f || timeChange <= 0.0f)
+	{
+		flywheel->target = flywheel->commandedTarget;
+		flywheel->targetRate = 0.0f;
+		mutexGive(flywheel->targetMutex);
+		return;
+	}
+
+	// Fastest rate that can still come to rest exactly at the commanded target.
+	float rate = remaining > 0.0f? acceleration : -acceleration;
+	if (jerk > 0.0f)
+	{
+		float stoppingRate = sqrtf(2.0f * jerk * fabsf(remaining));
+		if (stoppingRate < acceleration)
+		{
+			rate = remaining > 0.0f? stoppingRate : -stoppingRate;
+		}
+		float rateChange = rate - flywheel->targetRate;
+		float maxRateChange = jerk * timeChange;
+		if (rateChange > maxRateChange)
+		{
+			rate = flywheel->targetRate + maxRateChange;
+		}
+		else if (rateChange < -maxRateChange)
+		{
+			rate = flywheel->targetRate - maxRateChange;
+		}
+	}
+
+	// After a reversal the rate can still point away from the commanded target; the target then
+	// carries on past it, slowing through zero rate, rather than snapping back.
+	float step = rate * timeChange;
+	bool isTowards = step * remaining > 0.0f;
+	if (isTowards && fabsf(step) >= fabsf(remaining))
+	{
+		flywheel->target = flywheel->commandedTarget;
+		flywheel->targetRate = 0.0f;
+	}
+	else
+	{
+		flywheel->target += step;
+		flywheel->targetRate = rate;
+	}
+	mutexGive(flywheel->targetMutex);
+}
+
+
+void measureRpm(Flywheel *flywheel, int reading, float timeChange)
+{
+	if (timeChange <= 0.0f)
+	{
+		return;
+	}
+
+	float rpm = rawRpm(flywheel, reading, timeChange);
+
+	// Low-pass filter, discretized exactly by holding the raw rpm over the step,
+	// so it stays stable however long the step is compared to the smoothing.
+	float gain = lowPassGain(&flywheel->filter, timeChange, flywheel->smoothing);
+	float difference = rpm - flywheel->measured;
+	float measureChange = difference * gain;
+
+	// The exact integral of the filtered rpm over the step, and its derivative at the end of it.
+	// With no smoothing, the filter passes the raw rpm straight through.
+	float integralGain = flywheel->smoothing > 0.0f? flywheel->smoothing * gain : 0.0f;
+	float derivativeGain = integralGain > 0.0f? (1.0f - gain) / integralGain : 1.0f / timeChange;
 
 	// Update
-	flywheel->reading = reading;
 	flywheel->measuredRaw = rpm;
 	flywheel->measured += measureChange;
-	flywheel->derivative = measureChange / timeChange;
+	flywheel->derivative = measureChange * derivativeGain;
 
-	// Calculate error
+	// Calculate error, and its exact integral over the step.
+	float measuredIntegral = rpm * timeChange - difference * integralGain;
 	mutexTake(flywheel->targetMutex, -1);	// TODO: Find out what block time is suitable, or needeed at all.
 	flywheel->error = flywheel->measured - flywheel->target;
+	flywheel->errorIntegral += measuredIntegral - flywheel->target * timeChange;
 	mutexGive(flywheel->targetMutex);
 }
 
 
+// Estimates the load (e.g. a ball being launched) as the difference between the acceleration
+// the plant model expects from the applied action, and the acceleration actually measured.
+void observeLoad(Flywheel *flywheel, float timeChange)
+{
+	if (flywheel->plantTimeConstant <= 0.0f || timeChange <= 0.0f)
+	{
+		flywheel->load = 0.0f;
+		return;
+	}
+	float expectedDerivative = (flywheel->plantGain * flywheel->appliedAction - flywheel->measured) / flywheel->plantTimeConstant;
+	float load = expectedDerivative - flywheel->derivative;
+	flywheel->load += (load - flywheel->load) * lowPassGain(&flywheel->observerFilter, timeChange, flywheel->observerSmoothing);
+}
+
+
+// Converts a sensor reading to the unfiltered flywheel rpm.
+float rawRpm(Flywheel *flywheel, int reading, float timeChange)
+{
+	if (flywheel->sensor == FLYWHEEL_SENSOR_IME)
+	{
+		float rpm = reading / flywheel->imeVelocityDivisor * flywheel->gearing;
+		return flywheel->imeReverse? -rpm : rpm;
+	}
+
+	int ticks = reading - flywheel->reading;
+	flywheel->reading = reading;
+	return ticks / flywheel->encoderTicksPerRevolution * flywheel->gearing / timeChange * 60;
+}
+
+
 void controllerUpdate(Flywheel *flywheel, float timeChange)
 {
 	switch (flywheel->controllerType)
@@ -235,36 +637,74 @@ void controllerUpdate(Flywheel *flywheel, float timeChange)
 	case CONTROLLER_TYPE_BANG_BANG:
 		bangBangUpdate(flywheel, timeChange);
 		break;
+	case CONTROLLER_TYPE_STATE_SPACE:
+		stateSpaceUpdate(flywheel, timeChange);
+		break;
+	case CONTROLLER_TYPE_MPC:
+		mpcUpdate(flywheel, timeChange);
+		break;
 	}
-	if (flywheel->action > 127)
+	flywheel->action = clamp(flywheel->action, flywheel->limitMinimum, flywheel->limitMaximum);
+}
+
+// Adds the action that cancels the estimated load, and any boost for an imminent shot.
+void feedforwardUpdate(Flywheel *flywheel)
+{
+	float feedforward = 0.0f;
+	// The MPC table already accounts for the estimated load.
+	bool isLoadInController = flywheel->controllerType == CONTROLLER_TYPE_MPC;
+	if (!isLoadInController && flywheel->plantTimeConstant > 0.0f && flywheel->plantGain > 0.0f)
 	{
-		flywheel->action = 127;
+		feedforward = flywheel->observerGain * flywheel->load * flywheel->plantTimeConstant / flywheel->plantGain;
 	}
-	if (flywheel->action < -127)
+	if (flywheel->shotImminent)
 	{
-		flywheel->action = -127;
+		if (micros() - flywheel->shotMicroTime < FLYWHEEL_SHOT_BOOST_TIME)
+		{
+			feedforward += flywheel->shotBoost;
+		}
+		else
+		{
+			flywheel->shotImminent = false;
+		}
 	}
+	flywheel->feedforward = feedforward;
+	flywheel->appliedAction = clamp(flywheel->action + feedforward, flywheel->limitMinimum, flywheel->limitMaximum);
 }
 
 void pidUpdate(Flywheel *flywheel, float timeChange)
 {
-	flywheel->integral += flywheel->error * timeChange;
+	float minimum = flywheel->limitMinimum;
+	float maximum = flywheel->limitMaximum;
 
 	float proportionalPart = flywheel->pidKp * flywheel->error;
-	float integralPart = flywheel->pidKi * flywheel->integral;
 	float derivativePart = flywheel->pidKd * flywheel->derivative;
 
+	// Anti-windup: stop integrating while saturated and the error would drive it further in,
+	// and never let the integral part hold more than the output can use, so that the
+	// controller comes out of saturation as soon as the error turns around.
+	controlIntegrate(&flywheel->integral, derivativePart, flywheel->error, flywheel->stepErrorIntegral,
+		flywheel->pidKp, flywheel->pidKi, minimum, maximum);
+	float integralPart = 0.0f;
+	if (flywheel->pidKi != 0.0f)
+	{
+		integralPart = clamp(flywheel->pidKi * flywheel->integral, minimum, maximum);
+		flywheel->integral = integralPart / flywheel->pidKi;
+	}
+
 	flywheel->action = proportionalPart + integralPart + derivativePart;
 }
 
 void tbhUpdate(Flywheel *flywheel, float timeChange)
 {
-	flywheel->action += flywheel->error * timeChange * flywheel->tbhGain;
+	// The action is the integrator; keeping it within the output limits stops it winding up.
+	flywheel->action += flywheel->stepErrorIntegral * flywheel->tbhGain;
+	flywheel->action = clamp(flywheel->action, flywheel->limitMinimum, flywheel->limitMaximum);
 	if (signOf(flywheel->error) != signOf(flywheel->lastError))
 	{
 		if (flywheel->firstCross)
 		{
-			flywheel->action = flywheel->tbhApprox;
+			flywheel->action = approxAction(flywheel);
 			flywheel->firstCross = false;
 		}
 		else
@@ -288,22 +728,201 @@ void bangBangUpdate(Flywheel *flywheel, float timeChange)
 	}
 }
 
+// Feeds forward the action the model needs to hold the target, and feeds back the error and its
+// integral with gains precomputed on the host. The gains assume the active update period.
+void stateSpaceUpdate(Flywheel *flywheel, float timeChange)
+{
+	float feedforward = flywheel->target / STATE_SPACE_PLANT_GAIN;
+	// Same conditional integration as the PID controller, with the gains' opposite sign.
+	flywheel->action = controlIntegrate(&flywheel->integral, feedforward, flywheel->error, flywheel->stepErrorIntegral,
+		-STATE_SPACE_ERROR_GAIN, -STATE_SPACE_INTEGRAL_GAIN, flywheel->limitMinimum, flywheel->limitMaximum);
+}
+
+// Interpolates the action between the eight table entries around the target, error and estimated load.
+void mpcUpdate(Flywheel *flywheel, float timeChange)
+{
+	float loadWeight;
+	float targetWeight;
+	float errorWeight;
+	int load = mpcAxis(flywheel->load, 0.0f, MPC_TABLE_LOAD_SPACING, MPC_TABLE_LOAD_NODES, &loadWeight);
+	int target = mpcAxis(flywheel->target, 0.0f, MPC_TABLE_TARGET_SPACING, MPC_TABLE_TARGET_NODES, &targetWeight);
+	int error = mpcAxis(flywheel->error, MPC_TABLE_ERROR_MINIMUM, MPC_TABLE_ERROR_SPACING, MPC_TABLE_ERROR_NODES, &errorWeight);
+
+	float action = 0.0f;
+	int corner;
+	for (corner = 0; corner < 8; ++corner)
+	{
+		int l = (corner >> 2) & 1;
+		int t = (corner >> 1) & 1;
+		int e = corner & 1;
+		float weight = (l? loadWeight : 1.0f - loadWeight) * (t? targetWeight : 1.0f - targetWeight) * (e? errorWeight : 1.0f - errorWeight);
+		action += weight * mpcTable[load + l][target + t][error + e];
+	}
+	flywheel->action = action;
+}
+
+// Finds the node below the value on an evenly spaced table axis, clamping to the table's ends,
+// and how far the value is towards the next node.
+int mpcAxis(float value, float minimum, float spacing, int nodes, float *weight)
+{
+	float position = (value - minimum) / spacing;
+	if (position <= 0.0f)
+	{
+		*weight = 0.0f;
+		return 0;
+	}
+	if (position >= nodes - 1)
+	{
+		*weight = 1.0f;
+		return nodes - 2;
+	}
+	int node = (int)position;
+	*weight = position - node;
+	return node;
+}
+
+
+// The first-crossing action for the target: interpolated between the learnt nodes either side,
+// scaled from the nearest learnt node if only one side has been learnt, or the fixed approximation otherwise.
+float approxAction(Flywheel *flywheel)
+{
+	int node;
+	float weight;
+	if (!approxPosition(flywheel, &node, &weight))
+	{
+		return flywheel->tbhApprox;
+	}
+	unsigned int mask = flywheel->approxLearntMask;
+	if ((mask & (1u << node)) && (mask & (1u << (node + 1))))
+	{
+		return flywheel->approxNodes[node] + weight * (flywheel->approxNodes[node + 1] - flywheel->approxNodes[node]);
+	}
+	// The action is roughly proportional to speed once linearized, so scale from the nearest learnt node.
+	int distance;
+	for (distance = 0; distance < FLYWHEEL_APPROX_NODES; ++distance)
+	{
+		int lower = node - distance;
+		int upper = node + 1 + distance;
+		int nearer = weight < 0.5f? lower : upper;
+		int further = weight < 0.5f? upper : lower;
+		if (approxScalable(flywheel, nearer))
+		{
+			return flywheel->approxNodes[nearer] * flywheel->target / (nearer * flywheel->approxSpacing);
+		}
+		if (approxScalable(flywheel, further))
+		{
+			return flywheel->approxNodes[further] * flywheel->target / (further * flywheel->approxSpacing);
+		}
+	}
+	return flywheel->tbhApprox;
+}
+
+// Moves the nodes either side of the target towards the steady state action, in proportion to their closeness.
+void learnApprox(Flywheel *flywheel)
+{
+	int node;
+	float weight;
+	if (!flywheel->approxLearning || flywheel->controllerType == CONTROLLER_TYPE_BANG_BANG || !approxPosition(flywheel, &node, &weight))
+	{
+		return;
+	}
+	int i;
+	for (i = 0; i < 2; ++i)
+	{
+		unsigned int bit = 1u << (node + i);
+		if (!(flywheel->approxLearntMask & bit))
+		{
+			flywheel->approxNodes[node + i] = flywheel->action;
+			flywheel->approxLearntMask |= bit;
+		}
+	}
+	float predicted = flywheel->approxNodes[node] + weight * (flywheel->approxNodes[node + 1] - flywheel->approxNodes[node]);
+	float correction = FLYWHEEL_APPROX_LEARN_RATE * (flywheel->action - predicted);
+	flywheel->approxNodes[node] += (1.0f - weight) * correction;
+	flywheel->approxNodes[node + 1] += weight * correction;
+
+	// Small changes aren't worth a flash write.
+	for (i = 0; i < 2; ++i)
+	{
+		unsigned int bit = 1u << (node + i);
+		bool isNew = !(flywheel->approxSavedMask & bit);
+		if (isNew || fabsf(flywheel->approxNodes[node + i] - flywheel->approxSavedNodes[node + i]) > FLYWHEEL_APPROX_SAVE_THRESHOLD)
+		{
+			flywheel->approxChanged = true;
+		}
+	}
+}
+
+// Finds the lower node either side of the target, and how far the target is towards the upper node.
+bool approxPosition(Flywheel *flywheel, int *node, float *weight)
+{
+	if (flywheel->approxSpacing <= 0.0f || flywheel->target <= 0.0f)
+	{
+		return false;
+	}
+	float position = flywheel->target / flywheel->approxSpacing;
+	if (position >= FLYWHEEL_APPROX_NODES - 1)
+	{
+		return false;
+	}
+	*node = (int)position;
+	*weight = position - *node;
+	return true;
+}
+
+// Whether the node has been learnt and has a nonzero target to scale from.
+bool approxScalable(Flywheel *flywheel, int node)
+{
+	return 0 < node && node < FLYWHEEL_APPROX_NODES && (flywheel->approxLearntMask & (1u << node));
+}
+
+void loadApprox(Flywheel *flywheel)
+{
+	FILE *file = fopen(FLYWHEEL_APPROX_FILE, "r");
+	if (!file)
+	{
+		return;
+	}
+	unsigned int version = 0;
+	float spacing = 0.0f;
+	unsigned int mask = 0;
+	float nodes[FLYWHEEL_APPROX_NODES];
+	bool isRead = fread(&version, sizeof(version), 1, file) == 1
+		&& fread(&spacing, sizeof(spacing), 1, file) == 1
+		&& fread(&mask, sizeof(mask), 1, file) == 1
+		&& fread(nodes, sizeof(nodes[0]), FLYWHEEL_APPROX_NODES, file) == FLYWHEEL_APPROX_NODES;
+	fclose(file);
+
+	// Actions learnt with a different spacing are for different targets.
+	if (isRead && version == FLYWHEEL_APPROX_FILE_VERSION && spacing == flywheel->approxSpacing)
+	{
+		memcpy(flywheel->approxNodes, nodes, sizeof(nodes));
+		flywheel->approxLearntMask = mask;
+	}
+}
+
 
 void updateMotor(Flywheel *flywheel)
 {
-	for (int i = 0; flywheel->motorChannels[i]; i++)
+	controlOutput(&flywheel->motors, flywheel->motorType, flywheel->batteryCompensate, flywheel->appliedAction);
+	// A spinning flywheel draws far less current than the output suggests.
+	if (flywheel->plantGain > 0.0f)
 	{
-		int action = flywheel->motorReversed[i]? -flywheel->action : flywheel->action;
-		motorSet(flywheel->motorChannels[i], action);
+		controlSetSpeed(&flywheel->motors, flywheel->motorType, flywheel->measured / flywheel->plantGain);
 	}
 }
 
 
+void updateLimits(Flywheel *flywheel)
+{
+	controlLimits(&flywheel->motors, flywheel->motorType, flywheel->batteryCompensate,
+		flywheel->actionMinimum, flywheel->actionMaximum, &flywheel->limitMinimum, &flywheel->limitMaximum);
+}
+
+
 void checkReady(Flywheel *flywheel)
 {
-	bool errorReady = -FLYWHEEL_READY_ERROR_INTERVAL < flywheel->error && flywheel->error < FLYWHEEL_READY_ERROR_INTERVAL;
-	bool derivativeReady = -FLYWHEEL_READY_DERIVATIVE_INTERVAL < flywheel->derivative && flywheel->derivative < FLYWHEEL_READY_DERIVATIVE_INTERVAL;
-	bool ready = errorReady && derivativeReady;
+	bool ready = flywheelIsSettled(flywheel);
 
 	if (ready && !flywheel->ready)
 	{
@@ -316,6 +935,86 @@ void checkReady(Flywheel *flywheel)
 }
 
 
+// Wakes the controller as soon as the speed strays while ready, instead of waiting out the ready delay.
+void checkDisturbance(Flywheel *flywheel)
+{
+	if (!flywheel->ready)
+	{
+		return;
+	}
+	if (flywheel->error < -FLYWHEEL_DISTURBANCE_ERROR_INTERVAL || FLYWHEEL_DISTURBANCE_ERROR_INTERVAL < flywheel->error)
+	{
+		activate(flywheel);
+	}
+}
+
+
+// Cuts the output when the flywheel has been pushed hard but hasn't moved for a while, e.g. a ball
+// stuck in it, long before the motors' thermal breakers would trip. The output is retried after a
+// short time, backing off while the jam persists.
+void checkJam(Flywheel *flywheel, unsigned long microTime)
+{
+	if (flywheel->jammed)
+	{
+		if (microTime - flywheel->jamMicroTime >= flywheel->jamOffTime)
+		{
+			flywheel->jammed = false;
+			flywheel->stallMicroTime = 0;
+			activate(flywheel);
+		}
+		return;
+	}
+
+	if (!isStalled(flywheel))
+	{
+		flywheel->stallMicroTime = 0;
+		if (fabsf(flywheel->measured) >= FLYWHEEL_JAM_SPEED)
+		{
+			flywheel->jamOffTime = 0;
+		}
+		return;
+	}
+	if (!flywheel->stallMicroTime)
+	{
+		flywheel->stallMicroTime = microTime;
+	}
+	else if (microTime - flywheel->stallMicroTime >= FLYWHEEL_JAM_TIME)
+	{
+		flywheel->jammed = true;
+		flywheel->jamMicroTime = microTime;
+		++flywheel->jamCount;
+		// Back off if the flywheel never got going since the last jam.
+		if (!flywheel->jamOffTime)
+		{
+			flywheel->jamOffTime = FLYWHEEL_JAM_OFF_TIME;
+		}
+		else if (flywheel->jamOffTime < FLYWHEEL_JAM_MAXIMUM_OFF_TIME)
+		{
+			flywheel->jamOffTime *= 2;
+		}
+		// Wake the controller so the output is cut straight away.
+		activate(flywheel);
+	}
+}
+
+// Whether the flywheel is barely moving despite a large output, and, if there is a plant model,
+// accelerating much slower than the model expects for that output.
+bool isStalled(Flywheel *flywheel)
+{
+	float action = flywheel->appliedAction;
+	if (fabsf(action) < FLYWHEEL_JAM_ACTION || fabsf(flywheel->measured) >= FLYWHEEL_JAM_SPEED)
+	{
+		return false;
+	}
+	if (flywheel->plantTimeConstant > 0.0f && flywheel->plantGain > 0.0f)
+	{
+		float expected = (flywheel->plantGain * action - flywheel->measured) / flywheel->plantTimeConstant;
+		return fabsf(flywheel->derivative) < FLYWHEEL_JAM_ACCELERATION * fabsf(expected);
+	}
+	return true;
+}
+
+
 // Faster updates, higher priority, signals active.
 void activate(Flywheel *flywheel)
 {
@@ -324,6 +1023,7 @@ void activate(Flywheel *flywheel)
 	if (flywheel->task)
 	{
 		taskPrioritySet(flywheel->task, FLYWHEEL_ACTIVE_PRIORITY);
+		semaphoreGive(flywheel->wake);
 	}
 	// TODO: Signal not ready?
 }
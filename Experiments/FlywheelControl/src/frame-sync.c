@@ -0,0 +1,139 @@
+#include "frame-sync.h"
+
+#include <API.h>
+#include <math.h>
+
+
+
+
+#define FRAME_SYNC_NOMINAL_PERIOD 18500.0f      // Expected time, in microseconds, between master frames.
+#define FRAME_SYNC_MINIMUM_PERIOD 18000.0f      // Shortest frame period, in microseconds, the estimate can settle on.
+#define FRAME_SYNC_MAXIMUM_PERIOD 21000.0f      // Longest frame period, in microseconds, the estimate can settle on.
+#define FRAME_SYNC_PHASE_GAIN 0.2f              // Fraction of each observed phase error corrected straight away.
+#define FRAME_SYNC_PERIOD_GAIN 0.02f            // Fraction of each observed phase error, per frame, fed into the period.
+#define FRAME_SYNC_LOCK_COUNT 16                // Number of frames to observe before the estimate is used.
+
+#define FRAME_SYNC_PRIORITY 4                   // Priority of the observing task, high so its timestamps are accurate.
+#define FRAME_SYNC_POLL_DELAY 1                 // Delay, in milliseconds, between checks for new frame data.
+
+
+
+
+unsigned long frameSyncFrameTime = 0;   // Time, in microseconds, of a recent predicted frame.
+float frameSyncPeriod = FRAME_SYNC_NOMINAL_PERIOD;
+unsigned int frameSyncObservations = 0;
+TaskHandle frameSyncTask = NULL;
+
+
+
+
+// Private functions, forward declarations.
+
+void frameSyncObserveTask(void *args);
+unsigned int frameSyncFingerprint();
+void frameSyncObserve(unsigned long microTime);
+
+
+
+void frameSyncRun()
+{
+	if (!frameSyncTask)
+	{
+		frameSyncTask = taskCreate(frameSyncObserveTask, TASK_MINIMAL_STACK_SIZE * 2, NULL, FRAME_SYNC_PRIORITY);
+	}
+}
+
+
+unsigned long frameSyncDelay(unsigned long periodMs, unsigned long leadMicros)
+{
+	if (frameSyncObservations < FRAME_SYNC_LOCK_COUNT)
+	{
+		return periodMs;
+	}
+
+	float period = frameSyncPeriod;
+	long sinceFrame = (long)(micros() - frameSyncFrameTime);
+
+	// Pick the frame nearest to the requested period, then wake a little before it.
+	float frames = roundf((sinceFrame + periodMs * 1000.0f + leadMicros) / period);
+	float wakeIn = frames * period - sinceFrame - leadMicros;
+	while (wakeIn < 0.0f)
+	{
+		wakeIn += period;
+	}
+
+	return (unsigned long)(wakeIn / 1000.0f + 0.5f);
+}
+
+
+void frameSyncWait(unsigned long periodMs, unsigned long leadMicros)
+{
+	delay(frameSyncDelay(periodMs, leadMicros));
+}
+
+
+void frameSyncObserveTask(void *args)
+{
+	unsigned long wakeTime = millis();
+	unsigned int lastFingerprint = frameSyncFingerprint();
+	while (1)
+	{
+		taskDelayUntil(&wakeTime, FRAME_SYNC_POLL_DELAY);
+		unsigned int fingerprint = frameSyncFingerprint();
+		if (fingerprint != lastFingerprint)
+		{
+			// The data arrived some time since the last check; assume halfway.
+			frameSyncObserve(micros() - FRAME_SYNC_POLL_DELAY * 500);
+			lastFingerprint = fingerprint;
+		}
+	}
+}
+
+
+// Combines readings that only change when a new frame arrives from the master processor.
+unsigned int frameSyncFingerprint()
+{
+	unsigned int fingerprint = powerLevelMain();
+	for (unsigned char axis = 1; axis <= 4; axis++)
+	{
+		fingerprint = fingerprint * 31 + joystickGetAnalog(1, axis);
+	}
+	return fingerprint;
+}
+
+
+// Phase-locks the predicted frame times onto an observed frame.
+void frameSyncObserve(unsigned long microTime)
+{
+	if (frameSyncObservations == 0)
+	{
+		frameSyncFrameTime = microTime;
+		frameSyncObservations = 1;
+		return;
+	}
+
+	// Not every frame changes the readings, so compare against the nearest predicted frame.
+	float period = frameSyncPeriod;
+	long sinceFrame = (long)(microTime - frameSyncFrameTime);
+	float frames = roundf(sinceFrame / period);
+	float error = sinceFrame - frames * period;
+
+	frameSyncFrameTime += (long)(frames * period + error * FRAME_SYNC_PHASE_GAIN);
+	if (frames >= 1.0f)
+	{
+		period += error * FRAME_SYNC_PERIOD_GAIN / frames;
+		if (period < FRAME_SYNC_MINIMUM_PERIOD)
+		{
+			period = FRAME_SYNC_MINIMUM_PERIOD;
+		}
+		if (period > FRAME_SYNC_MAXIMUM_PERIOD)
+		{
+			period = FRAME_SYNC_MAXIMUM_PERIOD;
+		}
+		frameSyncPeriod = period;
+	}
+	if (frameSyncObservations < FRAME_SYNC_LOCK_COUNT)
+	{
+		++frameSyncObservations;
+	}
+}
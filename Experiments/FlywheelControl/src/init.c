@@ -33,7 +33,15 @@
  */
 
 #include "main.h"
+#include "ballistics.h"
+#include "com-input.h"
+#include "drive.h"
 #include "flywheel.h"
+#include "frame-sync.h"
+#include "odometry.h"
+#include "sensor-hub.h"
+#include "shooter.h"
+#include "state-space-gains.h"
 
 Flywheel *flywheel;
 
@@ -71,14 +79,116 @@ void initialize()
 		.pidKd = 0.0f,
 		.tbhGain = 0.0f,
 		.tbhApprox = 20,
+		.approxSpacing = 250.0f,
 		.bangBangValue = 20,
+		.profileAcceleration = 0.0f,
+		.profileJerk = 0.0f,
+		.actionMinimum = -127.0f,
+		.actionMaximum = 127.0f,
+		.plantGain = STATE_SPACE_PLANT_GAIN,
+		.plantTimeConstant = STATE_SPACE_TIME_CONSTANT,
+		.observerSmoothing = 0.05f,
+		// The time constant is there for jam detection; the observer feeds nothing forward until tuned.
+		.observerGain = 0.0f,
+		.shotBoost = 0.0f,
 		.smoothing = 0.2f,
 		.encoderTicksPerRevolution = 360,
+		.sensor = FLYWHEEL_SENSOR_ENCODER,
 		.encoderPortTop = 1,
 		.encoderPortBottom = 2,
 		.encoderReverse = false,
 		.motorChannels = { 1, 2, 3 },
-		.motorReversed = { true, true, false }
+		.motorReversed = { true, true, false },
+		// The state space gains were identified without linearization; see state-space-gains.h.
+		.motorType = MOTOR_TYPE_LINEAR,
+		.batteryCompensate = true
 	};
+	// Without the flywheel, the shooter and ballistics have nothing to drive, but the rest still starts.
 	flywheel = flywheelInit(flywheelSetup);
+	if (!flywheel)
+	{
+		printf("Flywheel sensor could not be added to the sensor hub\n");
+	}
+	frameSyncRun();
+
+	ShooterSetup shooterSetup =
+	{
+		.feederChannels = { 4 },
+		.feederReversed = { false },
+		.feedPower = 127,
+		.feedTime = 300000,
+		.transportDelay = 200000,
+		.readyError = 15.0f
+	};
+
+	// The drive gives way first when a port bank nears its limit, so the flywheel and feeder keep their output.
+	DriveSetup driveSetup =
+	{
+		.leftChannels = { 5, 6 },
+		.leftReversed = { false, false },
+		.rightChannels = { 7, 8 },
+		.rightReversed = { true, true },
+		.leftEncoderPortTop = 3,
+		.leftEncoderPortBottom = 4,
+		.leftEncoderReverse = false,
+		.rightEncoderPortTop = 5,
+		.rightEncoderPortBottom = 6,
+		.rightEncoderReverse = true,
+		.encoderTicksPerRevolution = 360,
+		.wheelDiameter = 4.0f,
+		.freeSpeed = 50.0f,
+		.maximumSpeed = 45.0f,
+		.deadband = 10,
+		.kp = -1.0f,
+		.ki = -4.0f,
+		.smoothing = 0.05f,
+		.slewRate = 500.0f,
+		.thermalWeight = 2.0f,
+		.motorType = MOTOR_TYPE_393,
+		.batteryCompensate = true
+	};
+	driveInit(driveSetup);
+
+	// The gyro calibrates as it starts, so the robot must be still. Odometry needs both drive encoders.
+	bool hasOdometry = driveLeft() && driveRight();
+	OdometrySetup odometrySetup;
+	if (hasOdometry)
+	{
+		odometrySetup = (OdometrySetup)
+		{
+			.leftSensor = driveLeft()->sensor,
+			.rightSensor = driveRight()->sensor,
+			.gyroSensor = sensorHubAddGyro(gyroInit(1, 0)),
+			.gyroReverse = false,
+			.inchesPerTick = driveLeft()->unitsPerTick,
+			.trackWidth = 14.0f
+		};
+	}
+	else
+	{
+		printf("Drive could not be added to the mechanisms\n");
+	}
+
+	// The ultrasonic points at the goal. It only sets the flywheel's target once turned on with
+	// "Ballistics active true", so that it doesn't fight targets set by hand or by a routine.
+	ballisticsSetActive(false);
+	if (flywheel && !ballisticsRun(flywheel, 7, 8))
+	{
+		printf("Ultrasonic could not be added to the sensor hub\n");
+	}
+
+	// Tasks started here keep running through every autonomous and driver control period,
+	// so the flywheel carries on from where it was instead of spinning up from scratch.
+	if (flywheel)
+	{
+		flywheelRun(flywheel);
+		shooterRun(flywheel, shooterSetup);
+	}
+	mechanismsRun();
+	if (hasOdometry)
+	{
+		odometryRun(odometrySetup);
+	}
+	stdinHandlerRun();
+	taskCreate(streamOutTask, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT);
 }
@@ -0,0 +1,245 @@
+#include "mechanism.h"
+
+#include <API.h>
+#include <math.h>
+#include "control.h"
+#include "sensor-hub.h"
+
+
+
+
+#define MECHANISM_SETTLED_TIME 0.1f             // Time in seconds a settled position mechanism may take to move by its tolerance.
+
+
+
+
+Mechanism mechanisms[MECHANISM_MAX];
+volatile int mechanismCount = 0;
+bool mechanismListening = false;
+
+
+
+
+// Private functions, forward declarations.
+
+void mechanismSample(const SensorSnapshot *snapshot, void *context);
+void mechanismTakeRequest(Mechanism *mechanism);
+void mechanismMeasure(Mechanism *mechanism, const SensorSnapshot *snapshot);
+void mechanismLimit(Mechanism *mechanism);
+float mechanismControl(Mechanism *mechanism, float timeChange);
+void mechanismOutput(Mechanism *mechanism);
+
+
+
+Mechanism *mechanismAdd(MechanismSetup setup)
+{
+	if (mechanismCount >= MECHANISM_MAX || setup.sensor < 0)
+	{
+		return NULL;
+	}
+	Mechanism *mechanism = &mechanisms[mechanismCount];
+
+	mechanism->mode = MECHANISM_MODE_OFF;
+	mechanism->target = 0.0f;
+	mechanism->position = 0.0f;
+	mechanism->velocity = 0.0f;
+	mechanism->error = 0.0f;
+	mechanism->integral = 0.0f;
+	mechanism->action = 0.0f;
+
+	mechanism->kf = setup.kf;
+	mechanism->kp = setup.kp;
+	mechanism->ki = setup.ki;
+	mechanism->kd = setup.kd;
+	bool hasLimits = setup.actionMinimum != 0.0f || setup.actionMaximum != 0.0f;
+	mechanism->actionMinimum = hasLimits? setup.actionMinimum : -127.0f;
+	mechanism->actionMaximum = hasLimits? setup.actionMaximum : 127.0f;
+	mechanism->limitMinimum = mechanism->actionMinimum;
+	mechanism->limitMaximum = mechanism->actionMaximum;
+	mechanism->slewRate = setup.slewRate;
+	mechanism->smoothing = setup.smoothing;
+	mechanism->freeSpeed = setup.freeSpeed;
+
+	mechanism->requestSequence = 0;
+	mechanism->requestMode = MECHANISM_MODE_OFF;
+	mechanism->requestTarget = 0.0f;
+	mechanism->requestCount = 0;
+	mechanism->appliedSequence = 0;
+
+	mechanism->sensor = setup.sensor;
+	mechanism->unitsPerTick = setup.unitsPerTick;
+	mechanism->reading = 0;
+	mechanism->microTime = 0;
+	mechanism->sampled = false;
+	mechanism->filter = (LowPassGain){ 0.0f, 0.0f, -1.0f };
+
+	mechanism->motors = motorGroupInit(setup.motorChannels, setup.motorReversed, 4);
+	mechanism->motorType = setup.motorType;
+	mechanism->batteryCompensate = setup.batteryCompensate;
+
+	// Only count it once it is filled in, as the hub task may already be updating the others.
+	++mechanismCount;
+	return mechanism;
+}
+
+
+void mechanismsRun()
+{
+	if (mechanismListening)
+	{
+		return;
+	}
+	mechanismListening = true;
+	sensorHubListen(mechanismSample, NULL);
+	sensorHubRun();
+}
+
+
+void mechanismSet(Mechanism *mechanism, MechanismMode mode, float target)
+{
+	mechanism->requestSequence = 0;
+	mechanism->requestMode = mode;
+	mechanism->requestTarget = target;
+	if (++mechanism->requestCount == 0)
+	{
+		++mechanism->requestCount;
+	}
+	mechanism->requestSequence = mechanism->requestCount;
+}
+
+
+void mechanismSetTarget(Mechanism *mechanism, float target)
+{
+	mechanismSet(mechanism, mechanism->requestMode, target);
+}
+
+
+bool mechanismIsSettled(Mechanism *mechanism, float tolerance)
+{
+	if (fabsf(mechanism->error) > tolerance)
+	{
+		return false;
+	}
+	return mechanism->mode != MECHANISM_MODE_POSITION
+		|| fabsf(mechanism->velocity) * MECHANISM_SETTLED_TIME <= tolerance;
+}
+
+
+
+// Updates every mechanism from the same snapshot, then sends all their outputs at once.
+void mechanismSample(const SensorSnapshot *snapshot, void *context)
+{
+	int count = mechanismCount;
+	bool isRunning = isEnabled();
+
+	for (int i = 0; i < count; i++)
+	{
+		Mechanism *mechanism = &mechanisms[i];
+		float timeChange = mechanism->sampled? (snapshot->microTime - mechanism->microTime) / 1000000.0f : 0.0f;
+		mechanismMeasure(mechanism, snapshot);
+		mechanismTakeRequest(mechanism);
+
+		mechanismLimit(mechanism);
+		// The kernel stops the motors while disabled; hold the integral and start again from rest.
+		float action = isRunning? mechanismControl(mechanism, timeChange) : 0.0f;
+		if (mechanism->slewRate > 0.0f && mechanism->mode != MECHANISM_MODE_OFF && isRunning)
+		{
+			float step = mechanism->slewRate * timeChange;
+			action = clamp(action, mechanism->action - step, mechanism->action + step);
+		}
+		mechanism->action = action;
+		mechanismOutput(mechanism);
+	}
+	motorsFlush();
+}
+
+
+// Takes up the latest mode and target, unless a request is being written, in which case it waits a tick.
+void mechanismTakeRequest(Mechanism *mechanism)
+{
+	unsigned long sequence = mechanism->requestSequence;
+	if (sequence == 0 || sequence == mechanism->appliedSequence)
+	{
+		return;
+	}
+	MechanismMode mode = mechanism->requestMode;
+	float target = mechanism->requestTarget;
+	if (sequence != mechanism->requestSequence)
+	{
+		return;
+	}
+	if (mode != mechanism->mode)
+	{
+		mechanism->mode = mode;
+		mechanism->integral = 0.0f;
+	}
+	mechanism->target = target;
+	mechanism->appliedSequence = sequence;
+}
+
+
+void mechanismMeasure(Mechanism *mechanism, const SensorSnapshot *snapshot)
+{
+	int reading = snapshot->values[mechanism->sensor];
+	mechanism->position = reading * mechanism->unitsPerTick;
+
+	if (mechanism->sampled)
+	{
+		float timeChange = (snapshot->microTime - mechanism->microTime) / 1000000.0f;
+		if (timeChange > 0.0f)
+		{
+			float velocity = (reading - mechanism->reading) * mechanism->unitsPerTick / timeChange;
+			float gain = lowPassGain(&mechanism->filter, timeChange, mechanism->smoothing);
+			mechanism->velocity += (velocity - mechanism->velocity) * gain;
+		}
+	}
+	mechanism->reading = reading;
+	mechanism->microTime = snapshot->microTime;
+	mechanism->sampled = true;
+}
+
+
+void mechanismLimit(Mechanism *mechanism)
+{
+	controlLimits(&mechanism->motors, mechanism->motorType, mechanism->batteryCompensate,
+		mechanism->actionMinimum, mechanism->actionMaximum, &mechanism->limitMinimum, &mechanism->limitMaximum);
+}
+
+
+float mechanismControl(Mechanism *mechanism, float timeChange)
+{
+	float base = 0.0f;
+	float derivative = 0.0f;
+
+	switch (mechanism->mode)
+	{
+	case MECHANISM_MODE_OFF:
+		mechanism->error = 0.0f;
+		return 0.0f;
+	case MECHANISM_MODE_OPEN_LOOP:
+		mechanism->error = 0.0f;
+		return clamp(mechanism->target, mechanism->limitMinimum, mechanism->limitMaximum);
+	case MECHANISM_MODE_VELOCITY:
+		mechanism->error = mechanism->velocity - mechanism->target;
+		base = mechanism->kf * mechanism->target;
+		break;
+	case MECHANISM_MODE_POSITION:
+		// Derivative on the measurement, so that target steps don't kick the output.
+		mechanism->error = mechanism->position - mechanism->target;
+		derivative = mechanism->kd * mechanism->velocity;
+		break;
+	}
+
+	return controlIntegrate(&mechanism->integral, base + derivative, mechanism->error, mechanism->error * timeChange,
+		mechanism->kp, mechanism->ki, mechanism->limitMinimum, mechanism->limitMaximum);
+}
+
+
+void mechanismOutput(Mechanism *mechanism)
+{
+	controlOutput(&mechanism->motors, mechanism->motorType, mechanism->batteryCompensate, mechanism->action);
+	if (mechanism->freeSpeed > 0.0f)
+	{
+		controlSetSpeed(&mechanism->motors, mechanism->motorType, 127.0f * mechanism->velocity / mechanism->freeSpeed);
+	}
+}
@@ -0,0 +1,194 @@
+#include "motors.h"
+
+#include <API.h>
+#include "thermal.h"
+
+
+
+
+#define MOTORS_CHANNEL_COUNT 10                 // Number of motor channels on the Cortex, numbered from 1.
+
+
+
+
+// Motor values that give a free speed proportional to the index, from 0 to 127.
+// This is the inverse of the 393's command to free speed curve. Const, so it stays in flash.
+// PLACEHOLDER: these are the figures commonly shared in the VEX community, not a characterization
+// of this robot's motors. To replace them, sweep the command from 0 to 127 on the unloaded flywheel,
+// log the steady speed at each step from the Data lines, and invert the resulting curve.
+const unsigned char motorLinearization393[128] =
+{
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,  21,  21,  21,  22,  22,  22,  23,  24,  24,
+	 25,  25,  25,  25,  26,  27,  27,  28,  28,  28,
+	 28,  29,  30,  30,  30,  31,  31,  32,  32,  32,
+	 33,  33,  34,  34,  35,  35,  35,  36,  36,  37,
+	 37,  37,  37,  38,  38,  39,  39,  39,  40,  40,
+	 41,  41,  42,  42,  43,  44,  44,  45,  45,  46,
+	 46,  47,  47,  48,  48,  49,  50,  50,  51,  52,
+	 52,  53,  54,  55,  56,  57,  57,  58,  59,  60,
+	 61,  62,  63,  64,  65,  66,  67,  67,  68,  70,
+	 71,  72,  72,  73,  74,  76,  77,  78,  79,  79,
+	 80,  81,  83,  84,  84,  86,  86,  87,  87,  88,
+	 88,  89,  89,  90,  90, 127, 127, 127
+};
+
+short motorsQueued[MOTORS_CHANNEL_COUNT + 1];      // Values to send, indexed by channel.
+short motorsSent[MOTORS_CHANNEL_COUNT + 1];        // Values last sent, indexed by channel.
+unsigned short motorsUsedMask = 0;      // Bit n is set if channel n has ever been given a value.
+unsigned short motorsSentMask = 0;      // Bit n is set if channel n is known to still hold its last sent value.
+unsigned long motorsWrites = 0;
+unsigned long motorsSkips = 0;
+Mutex motorsMutex = NULL;               // Held while flushing, by whichever task flushes.
+
+
+
+
+int motorLinearize(MotorType type, float command)
+{
+	int magnitude = (int)(command < 0? 0.5f - command : command + 0.5f);
+	if (magnitude > 127)
+	{
+		magnitude = 127;
+	}
+
+	int value;
+	switch (type)
+	{
+	case MOTOR_TYPE_393:
+		value = motorLinearization393[magnitude];
+		break;
+	case MOTOR_TYPE_LINEAR:
+	default:
+		value = magnitude;
+		break;
+	}
+	return command < 0? -value : value;
+}
+
+
+float motorDelinearize(MotorType type, int value)
+{
+	int magnitude = value < 0? -value : value;
+	if (magnitude > 127)
+	{
+		magnitude = 127;
+	}
+
+	int command;
+	switch (type)
+	{
+	case MOTOR_TYPE_393:
+		// The table only ever increases.
+		command = 0;
+		while (command < 127 && motorLinearization393[command] < magnitude)
+		{
+			++command;
+		}
+		break;
+	case MOTOR_TYPE_LINEAR:
+	default:
+		command = magnitude;
+		break;
+	}
+	return value < 0? -command : command;
+}
+
+
+MotorGroup motorGroupInit(const unsigned char *channels, const bool *reversed, int count)
+{
+	MotorGroup group = { 0, 0 };
+	for (int i = 0; i < count && channels[i]; i++)
+	{
+		group.channelMask |= 1 << channels[i];
+		if (reversed[i])
+		{
+			group.reversedMask |= 1 << channels[i];
+		}
+	}
+	motorsUsedMask |= group.channelMask;
+	// Groups are made from initialize(), before any task flushes.
+	if (!motorsMutex)
+	{
+		motorsMutex = mutexCreate();
+	}
+	return group;
+}
+
+
+void motorGroupSet(const MotorGroup *group, int value)
+{
+	for (int channel = 1; channel <= MOTORS_CHANNEL_COUNT; channel++)
+	{
+		if (group->channelMask & (1 << channel))
+		{
+			motorsQueued[channel] = (group->reversedMask & (1 << channel))? -value : value;
+		}
+	}
+}
+
+
+void motorsSet(unsigned char channel, int value)
+{
+	motorsQueued[channel] = value;
+	motorsUsedMask |= 1 << channel;
+}
+
+
+void motorsFlush()
+{
+	if (!motorsMutex)
+	{
+		motorsMutex = mutexCreate();
+	}
+	mutexTake(motorsMutex, -1);
+
+	// The kernel stops all motors while disabled, so the sent values can no longer be trusted.
+	bool isRunning = isEnabled();
+	if (!isRunning)
+	{
+		motorsSentMask = 0;
+	}
+	thermalUpdate(isRunning? motorsSent : NULL);
+
+	for (int channel = 1; channel <= MOTORS_CHANNEL_COUNT; channel++)
+	{
+		if (!(motorsUsedMask & (1 << channel)))
+		{
+			continue;
+		}
+		// Capped ahead of a PTC trip.
+		short limit = 127 * thermalScale(channel);
+		short value = motorsQueued[channel];
+		if (value > limit)
+		{
+			value = limit;
+		}
+		else if (value < -limit)
+		{
+			value = -limit;
+		}
+		if ((motorsSentMask & (1 << channel)) && value == motorsSent[channel])
+		{
+			++motorsSkips;
+			continue;
+		}
+		motorSet(channel, value);
+		motorsSent[channel] = value;
+		motorsSentMask |= 1 << channel;
+		++motorsWrites;
+	}
+	mutexGive(motorsMutex);
+}
+
+
+unsigned long motorsWriteCount()
+{
+	return motorsWrites;
+}
+
+
+unsigned long motorsSkipCount()
+{
+	return motorsSkips;
+}
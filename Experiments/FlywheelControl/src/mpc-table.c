@@ -0,0 +1,102 @@
+#include "mpc-table.h"
+
+// Generated by tools/mpc-table.py; regenerate rather than edit.
+
+const signed char mpcTable[MPC_TABLE_LOAD_NODES][MPC_TABLE_TARGET_NODES][MPC_TABLE_ERROR_NODES] =
+{
+	{
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 123, 107, 92, 77, 61, 46, 31, 15, 0, -15, -31, -46, -61, -77, -92, -107, -123, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 115, 100, 85, 69, 54, 39, 23, 8, -7, -23, -38, -53, -69, -84, -99, -115, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 123, 108, 93, 77, 62, 47, 31, 16, 1, -15, -30, -46, -61, -76, -92, -107, -122, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 116, 101, 85, 70, 55, 39, 24, 8, -7, -22, -38, -53, -68, -84, -99, -114, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 124, 108, 93, 78, 62, 47, 32, 16, 1, -14, -30, -45, -60, -76, -91, -106, -122, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 116, 101, 86, 70, 55, 40, 24, 9, -6, -22, -37, -52, -68, -83, -98, -114, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 124, 109, 94, 78, 63, 48, 32, 17, 2, -14, -29, -44, -60, -75, -90, -106, -121, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 117, 102, 86, 71, 56, 40, 25, 10, -6, -21, -37, -52, -67, -83, -98, -113, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 125, 110, 94, 79, 63, 48, 33, 17, 2, -13, -29, -44, -59, -75, -90, -105, -121, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 117, 102, 87, 71, 56, 41, 25, 10, -5, -21, -36, -51, -67, -82, -97, -113, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 125, 110, 95, 79, 64, 49, 33, 18, 3, -13, -28, -43, -59, -74, -89, -105, -119, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 118, 103, 87, 72, 57, 41, 26, 11, -5, -20, -35, -51, -66, -80, -94, -107, -121, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 126, 111, 95, 80, 65, 49, 34, 19, 3, -12, -28, -42, -55, -68, -82, -95, -109, -122, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 119, 103, 88, 72, 57, 42, 26, 11, -3, -16, -30, -43, -57, -70, -83, -97, -110, -124, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 126, 111, 96, 80, 65, 50, 36, 23, 9, -4, -18, -31, -45, -58, -72, -85, -99, -112, -125, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 119, 104, 88, 75, 61, 48, 34, 21, 8, -6, -19, -32, -45, -58, -71, -84, -97, -110, -123, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 114, 102, 89, 77, 64, 52, 39, 27, 14, 2, -11, -23, -36, -49, -61, -74, -86, -99, -111, -124, -127, -127, -127, -127 },
+	},
+	{
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 120, 105, 90, 74, 59, 44, 28, 13, -3, -18, -33, -49, -64, -79, -95, -110, -125, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 113, 97, 82, 67, 51, 36, 21, 5, -10, -25, -41, -56, -71, -87, -102, -117, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 121, 105, 90, 75, 59, 44, 29, 13, -2, -17, -33, -48, -63, -79, -94, -109, -125, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 113, 98, 83, 67, 52, 37, 21, 6, -9, -25, -40, -55, -71, -86, -101, -117, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 121, 106, 91, 75, 60, 45, 29, 14, -1, -17, -32, -47, -63, -78, -94, -109, -124, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 114, 99, 83, 68, 53, 37, 22, 6, -9, -24, -40, -55, -70, -86, -101, -116, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 122, 106, 91, 76, 60, 45, 30, 14, -1, -16, -32, -47, -62, -78, -93, -108, -124, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 114, 99, 84, 68, 53, 38, 22, 7, -8, -24, -39, -54, -70, -85, -100, -116, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 122, 107, 92, 76, 61, 46, 30, 15, 0, -16, -31, -46, -62, -77, -92, -108, -123, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 115, 100, 84, 69, 54, 38, 23, 8, -8, -23, -38, -54, -69, -85, -98, -112, -125, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 123, 108, 92, 77, 62, 46, 31, 15, 0, -15, -31, -46, -60, -73, -86, -100, -113, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 115, 100, 85, 69, 54, 39, 23, 8, -7, -21, -34, -48, -61, -75, -88, -102, -115, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 123, 108, 93, 77, 62, 47, 31, 18, 5, -9, -22, -36, -49, -63, -76, -90, -103, -117, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 116, 101, 85, 70, 57, 43, 30, 16, 3, -10, -24, -37, -51, -64, -77, -90, -103, -116, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 124, 109, 96, 82, 69, 56, 43, 30, 17, 4, -9, -21, -34, -47, -60, -73, -85, -98, -111, -123, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 126, 113, 101, 88, 76, 63, 50, 38, 25, 13, 0, -12, -25, -37, -50, -62, -75, -87, -100, -113, -125, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 114, 102, 89, 77, 64, 51, 39, 26, 14, 1, -11, -24, -36, -49, -61, -74, -86, -99, -112 },
+	},
+	{
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 118, 102, 87, 72, 56, 41, 26, 10, -5, -20, -36, -51, -66, -82, -97, -112, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 126, 110, 95, 80, 64, 49, 34, 18, 3, -12, -28, -43, -58, -74, -89, -105, -120, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 118, 103, 88, 72, 57, 42, 26, 11, -5, -20, -35, -51, -66, -81, -97, -112, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 126, 111, 95, 80, 65, 49, 34, 19, 3, -12, -27, -43, -58, -73, -89, -104, -119, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 119, 103, 88, 73, 57, 42, 27, 11, -4, -19, -35, -50, -65, -81, -96, -111, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 111, 96, 81, 65, 50, 35, 19, 4, -11, -27, -42, -57, -73, -88, -103, -119, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 119, 104, 89, 73, 58, 43, 27, 12, -3, -19, -34, -49, -65, -80, -96, -111, -126, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 112, 97, 81, 66, 51, 35, 20, 4, -11, -26, -42, -57, -72, -88, -103, -116, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 120, 104, 89, 74, 58, 43, 28, 12, -3, -18, -34, -49, -64, -78, -91, -105, -118, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 112, 97, 82, 66, 51, 36, 20, 5, -10, -25, -39, -52, -66, -79, -93, -106, -120, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 120, 105, 90, 74, 59, 44, 28, 13, 0, -13, -27, -40, -54, -67, -81, -94, -108, -121, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 113, 98, 82, 67, 52, 39, 25, 12, -2, -15, -29, -42, -55, -69, -82, -96, -109, -122, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 121, 106, 91, 78, 64, 51, 37, 24, 11, -2, -15, -28, -41, -54, -67, -80, -93, -106, -119, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 123, 111, 98, 86, 73, 61, 48, 36, 23, 11, -2, -15, -27, -40, -52, -65, -77, -90, -102, -115, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 124, 112, 99, 87, 74, 62, 49, 37, 24, 12, -1, -14, -26, -39, -51, -64, -76, -89, -101, -114, -126 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 125, 113, 100, 88, 75, 63, 50, 38, 25, 13, 0, -13, -25, -38, -50, -63, -75, -88 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 126, 114, 101, 89, 76, 64, 51, 39, 26, 14, 1, -12, -24, -37, -49 },
+	},
+	{
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 115, 100, 85, 69, 54, 38, 23, 8, -8, -23, -38, -54, -69, -84, -100, -115, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 123, 108, 92, 77, 62, 46, 31, 16, 0, -15, -30, -46, -61, -76, -92, -107, -122, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 116, 100, 85, 70, 54, 39, 24, 8, -7, -22, -38, -53, -68, -84, -99, -114, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 124, 108, 93, 78, 62, 47, 32, 16, 1, -14, -30, -45, -60, -76, -91, -107, -122, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 116, 101, 86, 70, 55, 40, 24, 9, -6, -22, -37, -53, -68, -83, -99, -114, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 124, 109, 94, 78, 63, 47, 32, 17, 1, -14, -29, -45, -60, -75, -91, -106, -121, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 117, 101, 86, 71, 55, 40, 25, 9, -6, -21, -37, -52, -67, -82, -96, -109, -123, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 125, 109, 94, 79, 63, 48, 33, 17, 2, -13, -29, -43, -57, -70, -84, -97, -111, -124, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 117, 102, 87, 71, 56, 41, 25, 10, -5, -18, -32, -45, -58, -72, -85, -99, -112, -126, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 125, 110, 95, 79, 64, 49, 34, 21, 7, -6, -20, -33, -47, -60, -73, -87, -100, -114, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 118, 103, 87, 73, 60, 46, 33, 19, 6, -8, -21, -34, -47, -60, -73, -86, -99, -112, -125, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 126, 112, 99, 86, 73, 60, 47, 35, 22, 9, -4, -16, -29, -41, -54, -67, -79, -92, -104, -117, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 122, 110, 97, 84, 72, 59, 47, 34, 22, 9, -3, -16, -28, -41, -53, -66, -79, -91, -104, -116, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 123, 111, 98, 85, 73, 60, 48, 35, 23, 10, -2, -15, -27, -40, -52, -65, -78, -90, -103 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 124, 112, 99, 86, 74, 61, 49, 36, 24, 11, -1, -14, -26, -39, -51, -64 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 125, 113, 100, 87, 75, 62, 50, 37, 25, 12, 0, -13, -25 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 126, 113, 101, 88, 76, 63, 51, 38, 26, 13 },
+	},
+	{
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 113, 97, 82, 67, 51, 36, 21, 5, -10, -25, -41, -56, -71, -87, -102, -117, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 121, 105, 90, 75, 59, 44, 29, 13, -2, -17, -33, -48, -64, -79, -94, -110, -125, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 113, 98, 83, 67, 52, 36, 21, 6, -10, -25, -40, -56, -71, -86, -102, -117, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 121, 106, 90, 75, 60, 44, 29, 14, -2, -17, -32, -48, -63, -78, -94, -109, -124, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 114, 98, 83, 68, 52, 37, 22, 6, -9, -24, -40, -55, -70, -86, -100, -114, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 122, 106, 91, 76, 60, 45, 30, 14, -1, -16, -32, -47, -61, -75, -88, -102, -115, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 114, 99, 84, 68, 53, 38, 22, 7, -8, -23, -36, -50, -63, -76, -90, -103, -117, -127, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 122, 107, 92, 76, 61, 45, 30, 16, 3, -11, -24, -38, -51, -65, -78, -91, -105, -118, -127, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 115, 99, 84, 69, 55, 41, 28, 15, 1, -12, -26, -39, -53, -66, -79, -92, -105, -118, -127, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 123, 107, 94, 80, 67, 53, 40, 27, 14, 1, -12, -24, -37, -50, -63, -76, -88, -101, -114, -127, -127, -127, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 120, 107, 95, 82, 70, 57, 45, 32, 19, 7, -6, -18, -31, -43, -56, -68, -81, -93, -106, -118, -127, -127, -127 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 121, 108, 96, 83, 71, 58, 46, 33, 20, 8, -5, -17, -30, -42, -55, -67, -80, -92, -105, -117 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 122, 109, 97, 84, 72, 59, 47, 34, 21, 9, -4, -16, -29, -41, -54, -66, -79 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 123, 110, 98, 85, 73, 60, 48, 35, 22, 10, -3, -15, -28, -40 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 124, 111, 99, 86, 74, 61, 49, 36, 23, 11, -2 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 125, 112, 100, 87, 75, 62, 49, 37 },
+		{ 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 126, 113, 101, 88, 76 },
+	},
+};
@@ -0,0 +1,262 @@
+#include "odometry.h"
+
+#include <API.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "sensor-hub.h"
+
+
+
+
+#define ODOMETRY_SINE_ONE 16384                 // Fixed point scale of the sine table.
+#define ODOMETRY_SINE_STEPS 256                 // Table steps per quarter revolution.
+#define ODOMETRY_SINE_SHIFT 6                   // Angle units per table step, as a power of two.
+#define ODOMETRY_QUARTER_SHIFT 14               // Angle units per quarter revolution, as a power of two.
+#define ODOMETRY_QUARTER (1 << ODOMETRY_QUARTER_SHIFT)
+#define ODOMETRY_GYRO_SHIFT 5                   // Each tick the heading moves 1/32 of the way to the gyro's, a time constant of 32 ticks.
+#define ODOMETRY_POSITION_SHIFT 15              // Positions accumulate with this many more fractional bits than they are published with.
+
+
+
+
+OdometrySetup odometrySetup;
+bool odometryRunning = false;
+short odometrySine[ODOMETRY_SINE_STEPS + 1];    // A quarter revolution of sine, from 0 to 1 inclusive.
+int64_t odometryDistanceGain;                   // Distance units per tick, with 16 fractional bits.
+int64_t odometryAngleGain;                      // Angle units per distance unit of difference between the sides, with 32 fractional bits.
+
+bool odometrySampled = false;
+int odometryLeft;                               // Distance travelled by each side, in distance units.
+int odometryRight;
+int odometryEncoderAngle;                       // Heading from the encoders alone.
+int odometryGyroOffset = 0;                     // Added to the gyro's angle to give the heading.
+int odometryHeading = 0;
+int64_t odometryX = 0;                          // Position with ODOMETRY_POSITION_SHIFT extra fractional bits.
+int64_t odometryY = 0;
+
+// Written like a published pose, with its sequence zero until it is whole, so the listener never takes half a reset.
+volatile OdometryPose odometryResetPose;
+unsigned long odometryResetCount = 0;           // Resets written, by the resetting task.
+unsigned long odometryResetApplied = 0;         // Sequence of the last reset taken up, by the hub task.
+
+// Double buffered, as in the sensor hub: the listener writes one pose while readers read the other.
+volatile OdometryPose odometryPoses[2];
+volatile int odometryPublished = 0;
+volatile bool odometryHasPose = false;
+unsigned long odometrySequence = 0;
+
+
+
+
+// Private functions, forward declarations.
+
+void odometrySample(const SensorSnapshot *snapshot, void *context);
+void odometryTakeReset(const SensorSnapshot *snapshot);
+int odometryDistance(int ticks);
+int odometryGyroAngle(const SensorSnapshot *snapshot);
+int odometrySineOf(int angle);
+int odometryQuarterSine(int position);
+void odometryPublish(unsigned long microTime);
+
+
+
+void odometryRun(OdometrySetup setup)
+{
+	if (odometryRunning)
+	{
+		return;
+	}
+	odometrySetup = setup;
+	for (int i = 0; i <= ODOMETRY_SINE_STEPS; i++)
+	{
+		odometrySine[i] = (short)roundf(ODOMETRY_SINE_ONE * sinf(1.57079633f * i / ODOMETRY_SINE_STEPS));
+	}
+	odometryDistanceGain = (int64_t)roundf(setup.inchesPerTick * ODOMETRY_DISTANCE_SCALE * 65536.0f);
+	odometryAngleGain = (int64_t)roundf(ODOMETRY_ANGLE_SCALE / (6.28318531f * setup.trackWidth * ODOMETRY_DISTANCE_SCALE) * 4294967296.0f);
+
+	odometryRunning = true;
+	sensorHubListen(odometrySample, NULL);
+	sensorHubRun();
+}
+
+
+bool odometryRead(OdometryPose *pose)
+{
+	// Until the first pose is published, there is no sequence to wait on.
+	if (!odometryHasPose)
+	{
+		memset(pose, 0, sizeof(OdometryPose));
+		return false;
+	}
+	while (1)
+	{
+		volatile OdometryPose *published = &odometryPoses[odometryPublished];
+		unsigned long sequence = published->sequence;
+		memcpy(pose, (const void *)published, sizeof(OdometryPose));
+		// Retry if the listener started rewriting this pose while it was being copied.
+		if (sequence && sequence == published->sequence)
+		{
+			return true;
+		}
+		taskDelay(0);
+	}
+}
+
+
+void odometryReset(float x, float y, float heading)
+{
+	odometryResetPose.sequence = 0;
+	odometryResetPose.x = (int)roundf(x * ODOMETRY_DISTANCE_SCALE);
+	odometryResetPose.y = (int)roundf(y * ODOMETRY_DISTANCE_SCALE);
+	odometryResetPose.heading = (int)roundf(heading * ODOMETRY_ANGLE_SCALE / 360.0f);
+	if (++odometryResetCount == 0)
+	{
+		++odometryResetCount;
+	}
+	odometryResetPose.sequence = odometryResetCount;
+}
+
+
+float odometryInches(int distance)
+{
+	return (float)distance / ODOMETRY_DISTANCE_SCALE;
+}
+
+
+float odometryDegrees(int angle)
+{
+	return angle * 360.0f / ODOMETRY_ANGLE_SCALE;
+}
+
+
+
+void odometrySample(const SensorSnapshot *snapshot, void *context)
+{
+	int left = odometryDistance(snapshot->values[odometrySetup.leftSensor]);
+	int right = odometryDistance(snapshot->values[odometrySetup.rightSensor]);
+	// From the total difference rather than summed steps, so that rounding doesn't build up.
+	int encoderAngle = (int)(((int64_t)(right - left) * odometryAngleGain) >> 32);
+
+	if (!odometrySampled)
+	{
+		odometryLeft = left;
+		odometryRight = right;
+		odometryEncoderAngle = encoderAngle;
+		odometryGyroOffset = -odometryGyroAngle(snapshot);
+		odometrySampled = true;
+	}
+	odometryTakeReset(snapshot);
+
+	int previousHeading = odometryHeading;
+	odometryHeading += encoderAngle - odometryEncoderAngle;
+	if (odometrySetup.gyroSensor >= 0)
+	{
+		int gyroHeading = odometryGyroAngle(snapshot) + odometryGyroOffset;
+		odometryHeading += (gyroHeading - odometryHeading + (1 << (ODOMETRY_GYRO_SHIFT - 1))) >> ODOMETRY_GYRO_SHIFT;
+	}
+
+	// Both sides summed is twice the distance travelled, which with the sine's 14 bits
+	// gives exactly the 15 extra fractional bits the position accumulates with.
+	int distance = (left - odometryLeft) + (right - odometryRight);
+	int midHeading = previousHeading + ((odometryHeading - previousHeading) >> 1);
+	odometryX += (int64_t)distance * odometrySineOf(midHeading + ODOMETRY_QUARTER);
+	odometryY += (int64_t)distance * odometrySineOf(midHeading);
+
+	odometryLeft = left;
+	odometryRight = right;
+	odometryEncoderAngle = encoderAngle;
+	odometryPublish(snapshot->microTime);
+}
+
+
+// Moves the pose to the latest reset, unless one is being written, in which case it waits a tick.
+void odometryTakeReset(const SensorSnapshot *snapshot)
+{
+	unsigned long sequence = odometryResetPose.sequence;
+	if (sequence == 0 || sequence == odometryResetApplied)
+	{
+		return;
+	}
+	int x = odometryResetPose.x;
+	int y = odometryResetPose.y;
+	int heading = odometryResetPose.heading;
+	if (sequence != odometryResetPose.sequence)
+	{
+		return;
+	}
+	odometryResetApplied = sequence;
+	odometryX = (int64_t)x << ODOMETRY_POSITION_SHIFT;
+	odometryY = (int64_t)y << ODOMETRY_POSITION_SHIFT;
+	odometryHeading = heading;
+	odometryGyroOffset = odometryHeading - odometryGyroAngle(snapshot);
+}
+
+
+int odometryDistance(int ticks)
+{
+	return (int)(((int64_t)ticks * odometryDistanceGain) >> 16);
+}
+
+
+int odometryGyroAngle(const SensorSnapshot *snapshot)
+{
+	if (odometrySetup.gyroSensor < 0)
+	{
+		return 0;
+	}
+	int degrees = snapshot->values[odometrySetup.gyroSensor];
+	int angle = degrees * ODOMETRY_ANGLE_SCALE / 360;
+	return odometrySetup.gyroReverse? -angle : angle;
+}
+
+
+// Sine, scaled by ODOMETRY_SINE_ONE, of an angle in pose units.
+int odometrySineOf(int angle)
+{
+	int position = angle & (ODOMETRY_QUARTER - 1);
+	switch ((angle >> ODOMETRY_QUARTER_SHIFT) & 3)
+	{
+	case 0:
+		return odometryQuarterSine(position);
+	case 1:
+		return odometryQuarterSine(ODOMETRY_QUARTER - position);
+	case 2:
+		return -odometryQuarterSine(position);
+	default:
+		return -odometryQuarterSine(ODOMETRY_QUARTER - position);
+	}
+}
+
+
+// Interpolates the table, for a position from 0 to a quarter revolution inclusive.
+int odometryQuarterSine(int position)
+{
+	int step = position >> ODOMETRY_SINE_SHIFT;
+	int fraction = position & ((1 << ODOMETRY_SINE_SHIFT) - 1);
+	if (fraction == 0)
+	{
+		return odometrySine[step];
+	}
+	return odometrySine[step] + (((odometrySine[step + 1] - odometrySine[step]) * fraction) >> ODOMETRY_SINE_SHIFT);
+}
+
+
+void odometryPublish(unsigned long microTime)
+{
+	int index = !odometryPublished;
+	volatile OdometryPose *pose = &odometryPoses[index];
+
+	pose->sequence = 0;
+	pose->microTime = microTime;
+	pose->x = (int)(odometryX >> ODOMETRY_POSITION_SHIFT);
+	pose->y = (int)(odometryY >> ODOMETRY_POSITION_SHIFT);
+	pose->heading = odometryHeading;
+	if (++odometrySequence == 0)
+	{
+		++odometrySequence;
+	}
+	pose->sequence = odometrySequence;
+	odometryPublished = index;
+	odometryHasPose = true;
+}
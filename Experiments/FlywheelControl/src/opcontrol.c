@@ -34,11 +34,18 @@
 
 #include "main.h"
 #include "com-input.h"
+#include "drive.h"
 #include "flywheel.h"
+#include "frame-sync.h"
+#include "motors.h"
+#include "routine.h"
+#include "shooter.h"
 #include "utils.h"
 #include <string.h>
 
-void streamOutTask(void *args);
+#define OPCONTROL_FRAME_LEAD 1000               // Time in microseconds before each master frame to read the joystick and set the drive.
+#define OPCONTROL_PERIOD 20                     // Time in milliseconds between drive updates, about one master frame.
+#define STREAM_PERIOD 80                        // Time in milliseconds between data lines.
 
 /*
  * Runs the user operator control code. This function will be started in its own task with the
@@ -60,29 +67,56 @@ void streamOutTask(void *args);
 
 void operatorControl()
 {
-	flywheelRun(flywheel);
-	stdinHandlerRun();
-
-	taskCreate(streamOutTask, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT);
+	// A routine cut short by the end of autonomous would leave the drive and shooter going.
+	routineStop();
 	while (1)
 	{
-		delay(1000);
+		driveTank(joystickGetAnalog(1, 3), joystickGetAnalog(1, 2));
+		// Wakes just before a master frame, when the joystick values read are the freshest.
+		frameSyncWait(OPCONTROL_PERIOD, OPCONTROL_FRAME_LEAD);
 	}
 }
 
 void streamOutTask(void *args)
 {
+	unsigned int count = 0;
+	unsigned int jamCount = 0;
+	ShotRecord shot;
 	while (1)
 	{
-		printf(
-			"Data %f %f %f %f %f %f \n",
-			flywheel->microTime / 1000000.0f,
-			flywheel->measuredRaw,
-			flywheel->measured,
-			flywheel->target,
-			flywheel->error,
-			flywheel->action
-		);
-		delay(80);
+		if (flywheel && flywheel->jamCount != jamCount)
+		{
+			jamCount = flywheel->jamCount;
+			printf("Jam %u\n", jamCount);
+		}
+		while (shooterNextRecord(&shot))
+		{
+			printf(
+				"Shot %u %f %f %f %f\n",
+				shot.number,
+				shot.requestTime / 1000000.0f,
+				shot.feedTime / 1000000.0f,
+				shot.arrivalTime / 1000000.0f,
+				shot.arrivalError
+			);
+		}
+		if (++count % 64 == 0)
+		{
+			printf("Motors %lu written %lu skipped\n", motorsWriteCount(), motorsSkipCount());
+		}
+		if (flywheel)
+		{
+			printf(
+				"Data %f %f %f %f %f %f \n",
+				flywheel->microTime / 1000000.0f,
+				flywheel->measuredRaw,
+				flywheel->measured,
+				flywheel->target,
+				flywheel->error,
+				flywheel->action
+			);
+		}
+		// Kept in step with the master frames, like the control loops.
+		frameSyncWait(STREAM_PERIOD, 0);
 	}
 }
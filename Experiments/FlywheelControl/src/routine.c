@@ -0,0 +1,456 @@
+#include "routine.h"
+
+#include <API.h>
+#include <math.h>
+#include "drive.h"
+#include "odometry.h"
+#include "sensor-hub.h"
+#include "shooter.h"
+#include "utils.h"
+
+
+
+
+#define ROUTINE_FILE "routine"                  // Name of the file the routine is saved in, at most 8 characters.
+#define ROUTINE_FILE_VERSION 1                  // Increment when the bytecode changes.
+#define ROUTINE_MAX_THREADS 8                   // Most branches running at once, counting the routine itself.
+#define ROUTINE_STEP_LIMIT 16                   // Most instructions a thread runs per step.
+
+#define ROUTINE_DRIVE_TOLERANCE 0.5f            // Distance in inches from the end of a drive at which it is done.
+#define ROUTINE_DRIVE_DECELERATION 60.0f        // Deceleration in inches per second squared approaching the end of a drive.
+#define ROUTINE_HEADING_GAIN 0.5f               // Wheel speed difference, in inches per second, per degree off heading.
+#define ROUTINE_TURN_TOLERANCE 1.0f             // Degrees from the end of a turn at which it is done.
+#define ROUTINE_TURN_GAIN 1.0f                  // Wheel speed, in inches per second, per degree left to turn.
+
+
+
+
+typedef struct RoutineThread
+{
+	bool active;
+	int pc;                             // Offset of the next instruction, or of the one in progress. Every thread ends at an END.
+	int parent;                         // Index of the thread waiting on this one, or -1.
+	int children;                       // Branches still running, while in a parallel instruction.
+	bool started;                       // Whether the instruction at pc has started.
+	unsigned long startTime;            // The time in microseconds the instruction started.
+	float startDistance;                // Average drive side position, in inches, when a drive started.
+	float targetHeading;                // Heading, in degrees, to hold or turn to.
+}
+RoutineThread;
+
+Flywheel *routineFlywheel = NULL;
+unsigned char routineProgram[ROUTINE_MAX_SIZE];
+int routineLength = 0;
+RoutineThread routineThreads[ROUTINE_MAX_THREADS];
+Semaphore routineTick = NULL;
+
+unsigned char routineUpload[ROUTINE_MAX_SIZE];
+int routineUploadLength = 0;
+
+const unsigned char routineOperandSizes[ROUTINE_OP_COUNT] = { 0, 3, 3, 2, 2, 1, 2, 1 };
+
+
+
+
+// Private functions, forward declarations.
+
+bool routineLoad();
+int routineCheck(const unsigned char *program, int start, int end);
+unsigned int routineCrc(const unsigned char *bytes, int count);
+bool routineRunThread(int index);
+bool routineExecute(RoutineThread *thread, bool isStarting, unsigned long microTime);
+bool routineDrive(RoutineThread *thread, bool isStarting, const unsigned char *operands);
+bool routineTurn(RoutineThread *thread, bool isStarting, const unsigned char *operands);
+bool routineSpawn(RoutineThread *thread, int index);
+void routineEndThread(int index);
+int routineReadShort(const unsigned char *bytes);
+float routineHeading();
+float routineDistance();
+void routineSample(const SensorSnapshot *snapshot, void *context);
+
+
+
+bool routineStart(Flywheel *flywheel)
+{
+	routineFlywheel = flywheel;
+	for (int i = 0; i < ROUTINE_MAX_THREADS; i++)
+	{
+		routineThreads[i].active = false;
+	}
+	// The drive and turn steps measure from the drive's encoders.
+	if (!driveLeft() || !driveRight() || !routineLoad())
+	{
+		return false;
+	}
+	routineThreads[0] = (RoutineThread){ .active = true, .pc = 0, .parent = -1 };
+	if (!routineTick)
+	{
+		routineTick = semaphoreCreate();
+		sensorHubListen(routineSample, NULL);
+	}
+	// Drop any tick given before the routine started, so that the first wait is for a fresh snapshot.
+	semaphoreTake(routineTick, 0);
+	return true;
+}
+
+
+bool routineStep()
+{
+	for (int i = 0; i < ROUTINE_MAX_THREADS; i++)
+	{
+		if (routineThreads[i].active && !routineRunThread(i))
+		{
+			routineStop();
+			return false;
+		}
+	}
+	return routineThreads[0].active;
+}
+
+
+void routineWait()
+{
+	// Falls back to the hub's period if the tick was missed or there was no room to listen for it.
+	semaphoreTake(routineTick, 2 * SENSOR_HUB_DELAY);
+}
+
+
+void routineStop()
+{
+	for (int i = 0; i < ROUTINE_MAX_THREADS; i++)
+	{
+		routineThreads[i].active = false;
+	}
+	driveSetSpeeds(0.0f, 0.0f);
+	shooterCancel();
+}
+
+
+void routineClear()
+{
+	routineUploadLength = 0;
+}
+
+
+bool routineAppend(const unsigned char *bytes, int count)
+{
+	if (routineUploadLength + count > ROUTINE_MAX_SIZE)
+	{
+		return false;
+	}
+	for (int i = 0; i < count; i++)
+	{
+		routineUpload[routineUploadLength++] = bytes[i];
+	}
+	return true;
+}
+
+
+bool routineSave(int length, unsigned int crc)
+{
+	if (isEnabled()
+		|| length != routineUploadLength
+		|| crc != routineCrc(routineUpload, routineUploadLength)
+		|| routineCheck(routineUpload, 0, routineUploadLength) < 0)
+	{
+		return false;
+	}
+	FILE *file = fopen(ROUTINE_FILE, "w");
+	if (!file)
+	{
+		return false;
+	}
+	unsigned int version = ROUTINE_FILE_VERSION;
+	bool isWritten = fwrite(&version, sizeof(version), 1, file) == 1
+		&& fwrite(&routineUploadLength, sizeof(routineUploadLength), 1, file) == 1
+		&& fwrite(routineUpload, 1, routineUploadLength, file) == (size_t)routineUploadLength;
+	fclose(file);
+	return isWritten;
+}
+
+
+
+bool routineLoad()
+{
+	FILE *file = fopen(ROUTINE_FILE, "r");
+	if (!file)
+	{
+		return false;
+	}
+	unsigned int version = 0;
+	int length = 0;
+	bool isRead = fread(&version, sizeof(version), 1, file) == 1
+		&& version == ROUTINE_FILE_VERSION
+		&& fread(&length, sizeof(length), 1, file) == 1
+		&& 0 < length && length <= ROUTINE_MAX_SIZE
+		&& fread(routineProgram, 1, length, file) == (size_t)length;
+	fclose(file);
+
+	// Checked once here, so the interpreter can trust every operand and branch length.
+	routineLength = isRead && routineCheck(routineProgram, 0, length) >= 0? length : 0;
+	return routineLength > 0;
+}
+
+
+// Returns the number of threads needed to run the bytes from start to end, or -1 if they aren't valid.
+int routineCheck(const unsigned char *program, int start, int end)
+{
+	int threads = 1;
+	int pc = start;
+	while (pc < end)
+	{
+		unsigned char opcode = program[pc];
+		if (opcode >= ROUTINE_OP_COUNT || pc + 1 + routineOperandSizes[opcode] > end)
+		{
+			return -1;
+		}
+		if (opcode == ROUTINE_OP_END)
+		{
+			// Nothing may follow the end.
+			return pc + 1 == end && threads <= ROUTINE_MAX_THREADS? threads : -1;
+		}
+		pc += 1 + routineOperandSizes[opcode];
+		if (opcode != ROUTINE_OP_PARALLEL)
+		{
+			continue;
+		}
+		int branches = program[pc - 1];
+		int branchThreads = 1;
+		for (int i = 0; i < branches; i++)
+		{
+			if (pc + 2 > end)
+			{
+				return -1;
+			}
+			int length = routineReadShort(&program[pc]);
+			pc += 2;
+			int needed = pc + length <= end? routineCheck(program, pc, pc + length) : -1;
+			if (needed < 0)
+			{
+				return -1;
+			}
+			branchThreads += needed;
+			pc += length;
+		}
+		if (branchThreads > threads)
+		{
+			threads = branchThreads;
+		}
+	}
+	return -1;
+}
+
+
+// CRC-16/CCITT, as Python's binascii.crc_hqx(bytes, 0xFFFF) computes it on the host.
+unsigned int routineCrc(const unsigned char *bytes, int count)
+{
+	unsigned int crc = 0xFFFF;
+	for (int i = 0; i < count; i++)
+	{
+		crc ^= bytes[i] << 8;
+		for (int bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 0x8000? (crc << 1) ^ 0x1021 : crc << 1) & 0xFFFF;
+		}
+	}
+	return crc;
+}
+
+
+// Runs instructions until one has to wait. Returns false if the routine can't continue.
+bool routineRunThread(int index)
+{
+	RoutineThread *thread = &routineThreads[index];
+	unsigned long microTime = micros();
+	for (int i = 0; i < ROUTINE_STEP_LIMIT && thread->active; i++)
+	{
+		if (routineProgram[thread->pc] == ROUTINE_OP_END)
+		{
+			routineEndThread(index);
+			break;
+		}
+		bool isStarting = !thread->started;
+		if (isStarting)
+		{
+			thread->started = true;
+			thread->startTime = microTime;
+			if (routineProgram[thread->pc] == ROUTINE_OP_PARALLEL && !routineSpawn(thread, index))
+			{
+				return false;
+			}
+		}
+		if (!routineExecute(thread, isStarting, microTime))
+		{
+			break;
+		}
+		thread->started = false;
+	}
+	return true;
+}
+
+
+// Starts or continues the instruction at the thread's pc. Returns whether it is done, having moved the pc on.
+bool routineExecute(RoutineThread *thread, bool isStarting, unsigned long microTime)
+{
+	const unsigned char *operands = &routineProgram[thread->pc + 1];
+	unsigned char opcode = routineProgram[thread->pc];
+	unsigned long elapsed = microTime - thread->startTime;
+	bool isDone = true;
+
+	switch (opcode)
+	{
+	case ROUTINE_OP_DRIVE:
+		isDone = routineDrive(thread, isStarting, operands);
+		break;
+	case ROUTINE_OP_TURN:
+		isDone = routineTurn(thread, isStarting, operands);
+		break;
+	case ROUTINE_OP_FLYWHEEL:
+		flywheelSet(routineFlywheel, (unsigned short)routineReadShort(operands));
+		break;
+	case ROUTINE_OP_WAIT_READY:
+	{
+		unsigned long timeout = (unsigned short)routineReadShort(operands) * 1000UL;
+		isDone = routineFlywheel->ready || (timeout > 0 && elapsed >= timeout);
+		break;
+	}
+	case ROUTINE_OP_FIRE:
+		if (isStarting)
+		{
+			shooterFire(operands[0]);
+		}
+		isDone = shooterPending() == 0;
+		break;
+	case ROUTINE_OP_WAIT:
+		isDone = elapsed >= (unsigned short)routineReadShort(operands) * 1000UL;
+		break;
+	case ROUTINE_OP_PARALLEL:
+		if (thread->children > 0)
+		{
+			return false;
+		}
+		// Skip over the branches, which have all ended.
+		thread->pc += 2;
+		for (int i = 0; i < operands[0]; i++)
+		{
+			thread->pc += 2 + routineReadShort(&routineProgram[thread->pc]);
+		}
+		return true;
+	}
+
+	if (isDone)
+	{
+		thread->pc += 1 + routineOperandSizes[opcode];
+	}
+	return isDone;
+}
+
+
+bool routineDrive(RoutineThread *thread, bool isStarting, const unsigned char *operands)
+{
+	float distance = routineReadShort(operands) / 10.0f;
+	float speed = operands[2];
+	if (isStarting)
+	{
+		thread->startDistance = routineDistance();
+		thread->targetHeading = routineHeading();
+	}
+
+	float remaining = distance - (routineDistance() - thread->startDistance);
+	if (fabsf(remaining) < ROUTINE_DRIVE_TOLERANCE || remaining * distance < 0.0f)
+	{
+		driveSetSpeeds(0.0f, 0.0f);
+		return true;
+	}
+	// Slows down in time to stop at the end, then holds the heading it started on.
+	float stoppingSpeed = sqrtf(2.0f * ROUTINE_DRIVE_DECELERATION * fabsf(remaining));
+	float forward = copysignf(stoppingSpeed < speed? stoppingSpeed : speed, remaining);
+	float correction = ROUTINE_HEADING_GAIN * (thread->targetHeading - routineHeading());
+	driveSetSpeeds(forward - correction, forward + correction);
+	return false;
+}
+
+
+bool routineTurn(RoutineThread *thread, bool isStarting, const unsigned char *operands)
+{
+	float speed = operands[2];
+	if (isStarting)
+	{
+		thread->targetHeading = routineHeading() + routineReadShort(operands) / 10.0f;
+	}
+
+	float remaining = thread->targetHeading - routineHeading();
+	if (fabsf(remaining) < ROUTINE_TURN_TOLERANCE)
+	{
+		driveSetSpeeds(0.0f, 0.0f);
+		return true;
+	}
+	float wheelSpeed = clamp(ROUTINE_TURN_GAIN * remaining, -speed, speed);
+	driveSetSpeeds(-wheelSpeed, wheelSpeed);
+	return false;
+}
+
+
+// Starts a thread for each branch of the parallel instruction at the thread's pc.
+bool routineSpawn(RoutineThread *thread, int index)
+{
+	int branches = routineProgram[thread->pc + 1];
+	int pc = thread->pc + 2;
+	int slot = 0;
+	thread->children = 0;
+	for (int i = 0; i < branches; i++)
+	{
+		int length = routineReadShort(&routineProgram[pc]);
+		pc += 2;
+		while (slot < ROUTINE_MAX_THREADS && routineThreads[slot].active)
+		{
+			++slot;
+		}
+		if (slot >= ROUTINE_MAX_THREADS)
+		{
+			return false;
+		}
+		routineThreads[slot] = (RoutineThread){ .active = true, .pc = pc, .parent = index };
+		++thread->children;
+		pc += length;
+	}
+	return true;
+}
+
+
+void routineEndThread(int index)
+{
+	RoutineThread *thread = &routineThreads[index];
+	thread->active = false;
+	if (thread->parent >= 0)
+	{
+		--routineThreads[thread->parent].children;
+	}
+}
+
+
+int routineReadShort(const unsigned char *bytes)
+{
+	return (short)(bytes[0] | bytes[1] << 8);
+}
+
+
+float routineHeading()
+{
+	OdometryPose pose;
+	odometryRead(&pose);
+	return odometryDegrees(pose.heading);
+}
+
+
+float routineDistance()
+{
+	return (driveLeft()->position + driveRight()->position) / 2.0f;
+}
+
+
+// Wakes the routine after each new snapshot.
+void routineSample(const SensorSnapshot *snapshot, void *context)
+{
+	semaphoreGive(routineTick);
+}
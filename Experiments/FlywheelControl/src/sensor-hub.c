@@ -0,0 +1,267 @@
+#include "sensor-hub.h"
+
+#include <API.h>
+#include <string.h>
+#include "analog-input.h"
+
+
+
+
+#define SENSOR_HUB_PRIORITY 4                   // Priority of the sampling task, high so that its ticks are regular.
+
+
+
+
+typedef enum SensorType
+{
+	SENSOR_TYPE_ENCODER,
+	SENSOR_TYPE_ANALOG,
+	SENSOR_TYPE_ANALOG_OVERSAMPLED,
+	SENSOR_TYPE_DIGITAL,
+	SENSOR_TYPE_JOYSTICK_AXIS,
+	SENSOR_TYPE_IME_COUNT,
+	SENSOR_TYPE_IME_VELOCITY,
+	SENSOR_TYPE_ULTRASONIC,
+	SENSOR_TYPE_GYRO
+}
+SensorType;
+
+typedef struct Sensor
+{
+	SensorType type;
+	unsigned char port;                 // Analog channel, digital pin, joystick number, or IME address.
+	unsigned char axis;                 // Joystick axis.
+	Encoder encoder;
+	Ultrasonic ultrasonic;
+	Gyro gyro;
+}
+Sensor;
+
+typedef struct SensorHubListener
+{
+	SensorListener listener;
+	void *context;
+}
+SensorHubListener;
+
+
+
+
+Sensor sensorHubSensors[SENSOR_HUB_MAX_SENSORS];
+int sensorHubSensorCount = 0;
+SensorHubListener sensorHubListeners[SENSOR_HUB_MAX_LISTENERS];
+int sensorHubListenerCount = 0;
+
+// Double buffered: the task writes one snapshot while readers read the other.
+volatile SensorSnapshot sensorHubSnapshots[2];
+volatile int sensorHubPublished = 0;    // Index of the snapshot readers should read.
+unsigned long sensorHubSequence = 0;
+TaskHandle sensorHubTask = NULL;
+bool sensorHubImesInitialized = false;
+
+
+
+
+// Private functions, forward declarations.
+
+int sensorHubAdd(Sensor sensor);
+void sensorHubSampleTask(void *args);
+void sensorHubSample();
+int sensorHubSampleSensor(const Sensor *sensor, int previous);
+
+
+
+int sensorHubAddEncoder(Encoder encoder)
+{
+	Sensor sensor = { .type = SENSOR_TYPE_ENCODER, .encoder = encoder };
+	return sensorHubAdd(sensor);
+}
+
+
+int sensorHubAddAnalog(unsigned char channel)
+{
+	Sensor sensor = { .type = SENSOR_TYPE_ANALOG, .port = channel };
+	return sensorHubAdd(sensor);
+}
+
+
+int sensorHubAddAnalogOversampled(unsigned char channel, bool calibrate)
+{
+	if (sensorHubSensorCount >= SENSOR_HUB_MAX_SENSORS || !analogInputAdd(channel, calibrate))
+	{
+		return -1;
+	}
+	analogInputRun();
+	Sensor sensor = { .type = SENSOR_TYPE_ANALOG_OVERSAMPLED, .port = channel };
+	return sensorHubAdd(sensor);
+}
+
+
+int sensorHubAddDigital(unsigned char pin)
+{
+	Sensor sensor = { .type = SENSOR_TYPE_DIGITAL, .port = pin };
+	return sensorHubAdd(sensor);
+}
+
+
+int sensorHubAddJoystickAxis(unsigned char joystick, unsigned char axis)
+{
+	Sensor sensor = { .type = SENSOR_TYPE_JOYSTICK_AXIS, .port = joystick, .axis = axis };
+	return sensorHubAdd(sensor);
+}
+
+
+int sensorHubAddImeCount(unsigned char address)
+{
+	Sensor sensor = { .type = SENSOR_TYPE_IME_COUNT, .port = address };
+	return sensorHubAdd(sensor);
+}
+
+
+int sensorHubAddImeVelocity(unsigned char address)
+{
+	Sensor sensor = { .type = SENSOR_TYPE_IME_VELOCITY, .port = address };
+	return sensorHubAdd(sensor);
+}
+
+
+int sensorHubAddUltrasonic(Ultrasonic ultrasonic)
+{
+	Sensor sensor = { .type = SENSOR_TYPE_ULTRASONIC, .ultrasonic = ultrasonic };
+	return sensorHubAdd(sensor);
+}
+
+
+int sensorHubAddGyro(Gyro gyro)
+{
+	Sensor sensor = { .type = SENSOR_TYPE_GYRO, .gyro = gyro };
+	return sensorHubAdd(sensor);
+}
+
+
+int sensorHubAdd(Sensor sensor)
+{
+	if (sensorHubSensorCount >= SENSOR_HUB_MAX_SENSORS)
+	{
+		return -1;
+	}
+	if ((sensor.type == SENSOR_TYPE_IME_COUNT || sensor.type == SENSOR_TYPE_IME_VELOCITY) && !sensorHubImesInitialized)
+	{
+		imeInitializeAll();
+		sensorHubImesInitialized = true;
+	}
+	// Fill in the sensor before counting it, so a running task never samples a half-added sensor.
+	sensorHubSensors[sensorHubSensorCount] = sensor;
+	return sensorHubSensorCount++;
+}
+
+
+bool sensorHubListen(SensorListener listener, void *context)
+{
+	if (sensorHubListenerCount >= SENSOR_HUB_MAX_LISTENERS)
+	{
+		return false;
+	}
+	sensorHubListeners[sensorHubListenerCount].listener = listener;
+	sensorHubListeners[sensorHubListenerCount].context = context;
+	++sensorHubListenerCount;
+	return true;
+}
+
+
+void sensorHubRun()
+{
+	if (!sensorHubTask)
+	{
+		sensorHubTask = taskCreate(sensorHubSampleTask, TASK_DEFAULT_STACK_SIZE, NULL, SENSOR_HUB_PRIORITY);
+	}
+}
+
+
+void sensorHubRead(SensorSnapshot *snapshot)
+{
+	while (1)
+	{
+		volatile SensorSnapshot *published = &sensorHubSnapshots[sensorHubPublished];
+		unsigned long sequence = published->sequence;
+		memcpy(snapshot, (const void *)published, sizeof(SensorSnapshot));
+		// Retry if the task started rewriting this snapshot while it was being copied.
+		if (sequence && sequence == published->sequence)
+		{
+			return;
+		}
+		taskDelay(0);
+	}
+}
+
+
+int sensorHubGet(int sensor)
+{
+	return sensorHubSnapshots[sensorHubPublished].values[sensor];
+}
+
+
+void sensorHubSampleTask(void *args)
+{
+	unsigned long wakeTime = millis();
+	while (1)
+	{
+		sensorHubSample();
+		taskDelayUntil(&wakeTime, SENSOR_HUB_DELAY);
+	}
+}
+
+
+void sensorHubSample()
+{
+	int index = !sensorHubPublished;
+	volatile SensorSnapshot *snapshot = &sensorHubSnapshots[index];
+	volatile SensorSnapshot *previous = &sensorHubSnapshots[sensorHubPublished];
+
+	snapshot->sequence = 0;
+	snapshot->microTime = micros();
+	for (int i = 0; i < sensorHubSensorCount; i++)
+	{
+		snapshot->values[i] = sensorHubSampleSensor(&sensorHubSensors[i], previous->values[i]);
+	}
+	if (++sensorHubSequence == 0)
+	{
+		++sensorHubSequence;
+	}
+	snapshot->sequence = sensorHubSequence;
+	sensorHubPublished = index;
+
+	for (int i = 0; i < sensorHubListenerCount; i++)
+	{
+		sensorHubListeners[i].listener((const SensorSnapshot *)snapshot, sensorHubListeners[i].context);
+	}
+}
+
+
+int sensorHubSampleSensor(const Sensor *sensor, int previous)
+{
+	int value;
+	switch (sensor->type)
+	{
+	case SENSOR_TYPE_ENCODER:
+		return encoderGet(sensor->encoder);
+	case SENSOR_TYPE_ANALOG:
+		return analogRead(sensor->port);
+	case SENSOR_TYPE_ANALOG_OVERSAMPLED:
+		return analogInputGet(sensor->port);
+	case SENSOR_TYPE_DIGITAL:
+		return digitalRead(sensor->port);
+	case SENSOR_TYPE_JOYSTICK_AXIS:
+		return joystickGetAnalog(sensor->port, sensor->axis);
+	// The value is undefined when a read fails, so the previous reading is kept.
+	case SENSOR_TYPE_IME_COUNT:
+		return imeGet(sensor->port, &value)? value : previous;
+	case SENSOR_TYPE_IME_VELOCITY:
+		return imeGetVelocity(sensor->port, &value)? value : previous;
+	case SENSOR_TYPE_ULTRASONIC:
+		return ultrasonicGet(sensor->ultrasonic);
+	case SENSOR_TYPE_GYRO:
+		return gyroGet(sensor->gyro);
+	}
+	return previous;
+}
@@ -0,0 +1,216 @@
+#include "shooter.h"
+
+#include <API.h>
+#include <math.h>
+#include "motors.h"
+#include "sensor-hub.h"
+
+
+
+
+#define SHOOTER_LOG_SIZE 8                      // Number of shot records kept until they are taken.
+#define SHOOTER_BOOST_LEAD 50000                // Time in microseconds before a ball arrives to boost the flywheel's output.
+
+
+
+
+typedef enum ShooterState
+{
+	SHOOTER_STATE_IDLE,                 // Nothing queued.
+	SHOOTER_STATE_WAITING,              // Waiting for the flywheel to be predicted ready in time.
+	SHOOTER_STATE_FEEDING               // The feeder is running, and the ball is on its way.
+}
+ShooterState;
+
+Flywheel *shooterFlywheel = NULL;
+ShooterSetup shooterSetup;
+MotorGroup shooterFeeder;
+ShooterState shooterState = SHOOTER_STATE_IDLE;
+volatile unsigned int shooterRequested = 0;     // Balls asked for, counted by shooterFire.
+volatile unsigned int shooterCompleted = 0;     // Balls fired or cancelled, counted by the sequencer.
+volatile bool shooterCancelling = false;
+bool shooterBoosted = false;
+bool shooterArrived = false;
+ShotRecord shooterShot;
+
+ShotRecord shooterLog[SHOOTER_LOG_SIZE];
+volatile unsigned int shooterLogHead = 0;       // Number of records written.
+unsigned int shooterLogTail = 0;                // Number of records taken or skipped.
+
+
+
+
+// Private functions, forward declarations.
+
+void shooterSample(const SensorSnapshot *snapshot, void *context);
+void shooterStartFeeding(unsigned long microTime);
+void shooterUpdateFeeding(unsigned long microTime);
+void shooterStopFeeding();
+
+
+
+void shooterRun(Flywheel *flywheel, ShooterSetup setup)
+{
+	if (shooterFlywheel)
+	{
+		return;
+	}
+	shooterSetup = setup;
+	shooterFeeder = motorGroupInit(setup.feederChannels, setup.feederReversed, 2);
+	shooterFlywheel = flywheel;
+	sensorHubListen(shooterSample, NULL);
+	sensorHubRun();
+}
+
+
+void shooterFire(unsigned int count)
+{
+	if (shooterFlywheel)
+	{
+		shooterRequested += count;
+	}
+}
+
+
+void shooterCancel()
+{
+	shooterCancelling = true;
+}
+
+
+unsigned int shooterPending()
+{
+	return shooterRequested - shooterCompleted;
+}
+
+
+float shooterTimeToReady()
+{
+	// Measured against the commanded target, so that a profiled target still ramping counts as not ready.
+	float error = shooterFlywheel->measured - shooterFlywheel->commandedTarget;
+	float distance = fabsf(error);
+	if (distance <= shooterSetup.readyError)
+	{
+		return 0.0f;
+	}
+	float derivative = shooterFlywheel->derivative;
+	if (error * derivative >= 0.0f)
+	{
+		return -1.0f;
+	}
+	// The error closes exponentially as the flywheel nears its target, at the rate it is closing now.
+	// While the output is saturated it closes linearly instead, so this errs on the late side.
+	float timeConstant = distance / fabsf(derivative);
+	return timeConstant * logf(distance / shooterSetup.readyError);
+}
+
+
+bool shooterNextRecord(ShotRecord *record)
+{
+	unsigned int head = shooterLogHead;
+	if (head - shooterLogTail > SHOOTER_LOG_SIZE)
+	{
+		shooterLogTail = head - SHOOTER_LOG_SIZE;
+	}
+	if (shooterLogTail == head)
+	{
+		return false;
+	}
+	*record = shooterLog[shooterLogTail % SHOOTER_LOG_SIZE];
+	++shooterLogTail;
+	return true;
+}
+
+
+
+void shooterSample(const SensorSnapshot *snapshot, void *context)
+{
+	unsigned long microTime = snapshot->microTime;
+
+	// The kernel stops the motors while disabled. Drop the queue rather than have shots left over
+	// from one period fire at the start of the next.
+	if (shooterCancelling || !isEnabled())
+	{
+		shooterCancelling = false;
+		if (shooterState != SHOOTER_STATE_IDLE)
+		{
+			shooterStopFeeding();
+			shooterState = SHOOTER_STATE_IDLE;
+		}
+		shooterCompleted = shooterRequested;
+		return;
+	}
+
+	switch (shooterState)
+	{
+	case SHOOTER_STATE_IDLE:
+		if (shooterPending() == 0)
+		{
+			break;
+		}
+		shooterShot.number = shooterCompleted + 1;
+		shooterShot.requestTime = microTime;
+		shooterState = SHOOTER_STATE_WAITING;
+		// Fall through, and feed this tick if the flywheel is already ready.
+	case SHOOTER_STATE_WAITING:
+	{
+		float timeToReady = shooterTimeToReady();
+		bool isReadyInTime = 0.0f <= timeToReady && timeToReady * 1000000.0f <= shooterSetup.transportDelay;
+		if (shooterFlywheel->commandedTarget > 0.0f && isReadyInTime)
+		{
+			shooterStartFeeding(microTime);
+		}
+		break;
+	}
+	case SHOOTER_STATE_FEEDING:
+		shooterUpdateFeeding(microTime);
+		break;
+	}
+}
+
+
+void shooterStartFeeding(unsigned long microTime)
+{
+	shooterShot.feedTime = microTime;
+	shooterBoosted = false;
+	shooterArrived = false;
+	motorGroupSet(&shooterFeeder, shooterSetup.feedPower);
+	motorsFlush();
+	shooterState = SHOOTER_STATE_FEEDING;
+}
+
+
+void shooterUpdateFeeding(unsigned long microTime)
+{
+	unsigned long sinceFeed = microTime - shooterShot.feedTime;
+
+	if (!shooterBoosted && sinceFeed + SHOOTER_BOOST_LEAD >= shooterSetup.transportDelay)
+	{
+		flywheelShotImminent(shooterFlywheel);
+		shooterBoosted = true;
+	}
+	if (!shooterArrived && sinceFeed >= shooterSetup.transportDelay)
+	{
+		shooterShot.arrivalTime = microTime;
+		shooterShot.arrivalError = shooterFlywheel->measured - shooterFlywheel->commandedTarget;
+		shooterLog[shooterLogHead % SHOOTER_LOG_SIZE] = shooterShot;
+		++shooterLogHead;
+		shooterArrived = true;
+	}
+	if (sinceFeed >= shooterSetup.feedTime)
+	{
+		shooterStopFeeding();
+	}
+	if (shooterArrived && sinceFeed >= shooterSetup.feedTime)
+	{
+		++shooterCompleted;
+		shooterState = SHOOTER_STATE_IDLE;
+	}
+}
+
+
+void shooterStopFeeding()
+{
+	motorGroupSet(&shooterFeeder, 0);
+	motorsFlush();
+}
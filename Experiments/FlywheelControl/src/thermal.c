@@ -0,0 +1,175 @@
+#include "thermal.h"
+
+#include <API.h>
+#include <stdlib.h>
+#include "utils.h"
+
+
+
+
+// Approximate figures for the 393 and the Cortex at battery voltage; tune them from observed trip times.
+#define THERMAL_STALL_CURRENT 4.8f              // Current, in amps, a 393 draws when stalled at full output.
+#define THERMAL_MOTOR_TRIP_CURRENT 1.8f         // Steady current, in amps, that eventually trips a motor's PTC.
+#define THERMAL_MOTOR_TIME_CONSTANT 15.0f       // Time constant, in seconds, of a motor PTC heating up and cooling down.
+#define THERMAL_BANK_TRIP_CURRENT 4.0f          // Steady current, in amps, that eventually trips a Cortex port bank's PTC.
+#define THERMAL_BANK_TIME_CONSTANT 25.0f        // Time constant, in seconds, of a bank PTC heating up and cooling down.
+
+#define THERMAL_START_LOAD 0.6f                 // Fraction of the trip heat at which outputs start being scaled down.
+#define THERMAL_LIMIT_LOAD 0.9f                 // Fraction of the trip heat at which outputs are scaled down the most.
+#define THERMAL_MINIMUM_SCALE 0.3f              // Smallest factor outputs are scaled by.
+
+#define THERMAL_PERIOD 100000                   // Time in microseconds between updates of the estimates.
+#define THERMAL_CHANNEL_COUNT 10                // Number of motor channels on the Cortex, numbered from 1.
+#define THERMAL_BANK_COUNT 2                    // Ports 1-5 and ports 6-10 are each behind their own PTC.
+
+
+
+
+float thermalMotorHeat[THERMAL_CHANNEL_COUNT + 1];      // Low-passed squared current, in amps squared, indexed by channel.
+float thermalBankHeat[THERMAL_BANK_COUNT];
+float thermalSpeed[THERMAL_CHANNEL_COUNT + 1];          // Fraction of free speed, indexed by channel.
+float thermalWeight[THERMAL_CHANNEL_COUNT + 1] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+float thermalScales[THERMAL_CHANNEL_COUNT + 1] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+unsigned long thermalMicroTime = 0;
+bool thermalSampled = false;
+LowPassGain thermalMotorFilter = { 0.0f, 0.0f, -1.0f };
+LowPassGain thermalBankFilter = { 0.0f, 0.0f, -1.0f };
+
+
+
+
+// Private functions, forward declarations.
+
+int thermalBank(int channel);
+float thermalLimit(float heat, float tripCurrent);
+
+
+
+void thermalUpdate(const short *values)
+{
+	unsigned long microTime = micros();
+	if (thermalSampled && microTime - thermalMicroTime < THERMAL_PERIOD)
+	{
+		return;
+	}
+	float timeChange = thermalSampled? (microTime - thermalMicroTime) / 1000000.0f : 0.0f;
+	thermalMicroTime = microTime;
+	thermalSampled = true;
+
+	float motorGain = lowPassGain(&thermalMotorFilter, timeChange, THERMAL_MOTOR_TIME_CONSTANT);
+	float bankGain = lowPassGain(&thermalBankFilter, timeChange, THERMAL_BANK_TIME_CONSTANT);
+
+	// The current is driven by the output less the motor's back EMF.
+	float bankCurrents[THERMAL_BANK_COUNT] = { 0.0f, 0.0f };
+	for (int channel = 1; channel <= THERMAL_CHANNEL_COUNT; channel++)
+	{
+		float output = values? abs(values[channel]) / 127.0f : 0.0f;
+		float current = output > thermalSpeed[channel]? THERMAL_STALL_CURRENT * (output - thermalSpeed[channel]) : 0.0f;
+		thermalMotorHeat[channel] += (current * current - thermalMotorHeat[channel]) * motorGain;
+		bankCurrents[thermalBank(channel)] += current;
+	}
+
+	float bankCuts[THERMAL_BANK_COUNT];
+	float bankWeights[THERMAL_BANK_COUNT] = { 0.0f, 0.0f };
+	for (int bank = 0; bank < THERMAL_BANK_COUNT; bank++)
+	{
+		thermalBankHeat[bank] += (bankCurrents[bank] * bankCurrents[bank] - thermalBankHeat[bank]) * bankGain;
+		bankCuts[bank] = 1.0f - thermalLimit(thermalBankHeat[bank], THERMAL_BANK_TRIP_CURRENT);
+	}
+	for (int channel = 1; channel <= THERMAL_CHANNEL_COUNT; channel++)
+	{
+		int bank = thermalBank(channel);
+		if (thermalWeight[channel] > bankWeights[bank])
+		{
+			bankWeights[bank] = thermalWeight[channel];
+		}
+	}
+
+	// The most heavily weighted channels in a bank take its whole cut; the others take a share.
+	for (int channel = 1; channel <= THERMAL_CHANNEL_COUNT; channel++)
+	{
+		int bank = thermalBank(channel);
+		float bankScale = 1.0f;
+		if (bankWeights[bank] > 0.0f)
+		{
+			bankScale = 1.0f - bankCuts[bank] * thermalWeight[channel] / bankWeights[bank];
+		}
+		thermalScales[channel] = bankScale * thermalLimit(thermalMotorHeat[channel], THERMAL_MOTOR_TRIP_CURRENT);
+	}
+}
+
+
+float thermalScale(unsigned char channel)
+{
+	return thermalScales[channel];
+}
+
+
+float thermalGroupScale(const MotorGroup *group)
+{
+	float scale = 1.0f;
+	for (int channel = 1; channel <= THERMAL_CHANNEL_COUNT; channel++)
+	{
+		if ((group->channelMask & (1 << channel)) && thermalScales[channel] < scale)
+		{
+			scale = thermalScales[channel];
+		}
+	}
+	return scale;
+}
+
+
+void thermalSetSpeed(const MotorGroup *group, float fraction)
+{
+	for (int channel = 1; channel <= THERMAL_CHANNEL_COUNT; channel++)
+	{
+		if (group->channelMask & (1 << channel))
+		{
+			thermalSpeed[channel] = fraction;
+		}
+	}
+}
+
+
+void thermalSetWeight(const MotorGroup *group, float weight)
+{
+	for (int channel = 1; channel <= THERMAL_CHANNEL_COUNT; channel++)
+	{
+		if (group->channelMask & (1 << channel))
+		{
+			thermalWeight[channel] = weight;
+		}
+	}
+}
+
+
+float thermalMotorLoad(unsigned char channel)
+{
+	return thermalMotorHeat[channel] / (THERMAL_MOTOR_TRIP_CURRENT * THERMAL_MOTOR_TRIP_CURRENT);
+}
+
+
+float thermalBankLoad(int bank)
+{
+	return thermalBankHeat[bank] / (THERMAL_BANK_TRIP_CURRENT * THERMAL_BANK_TRIP_CURRENT);
+}
+
+
+
+int thermalBank(int channel)
+{
+	return channel <= 5? 0 : 1;
+}
+
+
+// Scales down linearly from the start load to the limit load, so that the heat settles in between.
+float thermalLimit(float heat, float tripCurrent)
+{
+	float load = heat / (tripCurrent * tripCurrent);
+	if (load <= THERMAL_START_LOAD)
+	{
+		return 1.0f;
+	}
+	float scale = 1.0f - (1.0f - THERMAL_MINIMUM_SCALE) * (load - THERMAL_START_LOAD) / (THERMAL_LIMIT_LOAD - THERMAL_START_LOAD);
+	return scale > THERMAL_MINIMUM_SCALE? scale : THERMAL_MINIMUM_SCALE;
+}
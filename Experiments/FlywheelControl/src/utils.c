@@ -2,9 +2,13 @@
 
 #include <API.h>
 //#include <ctype.h>
+#include <math.h>
 #include <string.h>
 
 
+#define LOW_PASS_TIME_TOLERANCE 0.00001f        // Time change, in seconds, that can drift before a low-pass gain is recalculated; 0.2% of a hub tick.
+
+
 
 //
 // Updates the given variable with the current time in microseconds,
@@ -26,6 +30,33 @@ int signOf(int x)
 }
 
 
+float clamp(float value, float minimum, float maximum)
+{
+	if (value > maximum)
+	{
+		return maximum;
+	}
+	if (value < minimum)
+	{
+		return minimum;
+	}
+	return value;
+}
+
+
+float lowPassGain(LowPassGain *cache, float timeChange, float smoothing)
+{
+	if (smoothing == cache->smoothing && fabsf(timeChange - cache->timeChange) < LOW_PASS_TIME_TOLERANCE)
+	{
+		return cache->gain;
+	}
+	cache->gain = smoothing > 0.0f? 1.0f - expf(-timeChange / smoothing) : 1.0f;
+	cache->timeChange = timeChange;
+	cache->smoothing = smoothing;
+	return cache->gain;
+}
+
+
 bool stringStartsWith(char const *pre, char const *string)
 {
 	size_t stringLength = strlen(string);
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""
+Computes the gains for the flywheel's state space controller, and writes them
+to include/state-space-gains.h.
+
+The flywheel is modelled as a first order plant,
+    d(speed)/dt = (plantGain * action - speed) / timeConstant,
+augmented with the integral of the speed error. The discrete LQR gains are
+found for the controller's update period, with Bryson's rule weights.
+
+The plant can be given directly, or identified from a log recorded by the
+controls program (a CSV with time, measured and action columns). The action
+in the log must map to motor values the same way it does on the robot now;
+pass --raw-log for a log recorded before output linearization, and the header
+is marked as not matching a linearized flywheel.
+
+Usage:
+    lqr-gains.py --gain 10 --tau 1.0
+    lqr-gains.py --log ../results/2015-07-19.5.csv --raw-log
+"""
+
+import argparse
+import csv
+import math
+import os
+
+
+HEADER_PATH = os.path.join(os.path.dirname(__file__), '..', 'include', 'state-space-gains.h')
+
+
+def identify(path):
+    """Least squares fit of speed[k+1] = a * speed[k] + c * action[k], resampled to each logged step."""
+    times, speeds, actions = [], [], []
+    with open(path) as log:
+        for row in csv.DictReader(log):
+            times.append(float(row['time']))
+            speeds.append(float(row['measured']))
+            actions.append(float(row['action']))
+
+    sxx = sxu = suu = sxy = suy = 0.0
+    period = 0.0
+    count = 0
+    for k in range(len(times) - 1):
+        step = times[k + 1] - times[k]
+        if step <= 0.0:
+            continue
+        x, u, y = speeds[k], actions[k], speeds[k + 1]
+        sxx += x * x
+        sxu += x * u
+        suu += u * u
+        sxy += x * y
+        suy += u * y
+        period += step
+        count += 1
+    if count == 0:
+        raise SystemExit('No usable samples in ' + path)
+    period /= count
+
+    determinant = sxx * suu - sxu * sxu
+    a = (sxy * suu - suy * sxu) / determinant
+    c = (suy * sxx - sxy * sxu) / determinant
+    if not 0.0 < a < 1.0:
+        raise SystemExit('Identified an unstable or non-physical plant (a = %g)' % a)
+    timeConstant = -period / math.log(a)
+    plantGain = c / (1.0 - a)
+    return plantGain, timeConstant
+
+
+def discretize(plantGain, timeConstant, period):
+    """Zero order hold discretization of the plant with the error integral as a second state."""
+    a = math.exp(-period / timeConstant)
+    A = [[a, 0.0],
+         [timeConstant * (1.0 - a), 1.0]]
+    B = [plantGain * (1.0 - a),
+         plantGain * (period - timeConstant * (1.0 - a))]
+    return A, B
+
+
+def lqr(A, B, Q, R, iterations=100000, tolerance=1e-12):
+    """Iterates the discrete Riccati equation to convergence; returns K for action = -K x."""
+    P = [row[:] for row in Q]
+    for _ in range(iterations):
+        # PB = P B, BPB = B' P B, BPA = B' P A
+        PB = [P[0][0] * B[0] + P[0][1] * B[1], P[1][0] * B[0] + P[1][1] * B[1]]
+        BPB = B[0] * PB[0] + B[1] * PB[1]
+        BPA = [PB[0] * A[0][j] + PB[1] * A[1][j] for j in range(2)]
+        K = [BPA[j] / (R + BPB) for j in range(2)]
+        # P = Q + A' P A - A' P B K
+        PA = [[sum(P[i][m] * A[m][j] for m in range(2)) for j in range(2)] for i in range(2)]
+        APA = [[sum(A[m][i] * PA[m][j] for m in range(2)) for j in range(2)] for i in range(2)]
+        next = [[Q[i][j] + APA[i][j] - BPA[i] * K[j] for j in range(2)] for i in range(2)]
+        change = max(abs(next[i][j] - P[i][j]) for i in range(2) for j in range(2))
+        P = next
+        if change < tolerance * max(1.0, abs(P[0][0])):
+            return K
+    raise SystemExit('Riccati iteration did not converge')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--gain', type=float, help='steady state rpm per unit of action')
+    parser.add_argument('--tau', type=float, help='time constant of the speed response, in seconds')
+    parser.add_argument('--log', help='CSV log to identify the plant from, instead of --gain and --tau')
+    parser.add_argument('--period', type=float, default=0.02, help='controller update period while active, in seconds')
+    parser.add_argument('--max-error', type=float, default=50.0, help='acceptable speed error, in rpm')
+    parser.add_argument('--max-integral', type=float, default=10.0, help='acceptable error integral, in rpm seconds')
+    parser.add_argument('--max-action', type=float, default=127.0, help='acceptable action')
+    parser.add_argument('--raw-log', action='store_true', help='the log was recorded with actions sent as raw motor values, without linearization')
+    parser.add_argument('--output', default=HEADER_PATH, help='header to write')
+    args = parser.parse_args()
+
+    if args.log:
+        plantGain, timeConstant = identify(args.log)
+        source = 'identified from ' + os.path.basename(args.log)
+    elif args.gain and args.tau:
+        plantGain, timeConstant = args.gain, args.tau
+        source = 'given'
+    else:
+        parser.error('either --log, or both --gain and --tau, are needed')
+
+    A, B = discretize(plantGain, timeConstant, args.period)
+    Q = [[1.0 / args.max_error ** 2, 0.0], [0.0, 1.0 / args.max_integral ** 2]]
+    R = 1.0 / args.max_action ** 2
+    errorGain, integralGain = lqr(A, B, Q, R)
+
+    constants = [
+        ('STATE_SPACE_PLANT_GAIN', plantGain, 'Steady state rpm per unit of action.'),
+        ('STATE_SPACE_TIME_CONSTANT', timeConstant, 'Time constant of the speed response, in seconds.'),
+        ('STATE_SPACE_PERIOD', args.period, 'Update period, in seconds, the gains were calculated for.'),
+        ('STATE_SPACE_ERROR_GAIN', errorGain, 'Action per rpm of error.'),
+        ('STATE_SPACE_INTEGRAL_GAIN', integralGain, 'Action per rpm second of error integral.'),
+    ]
+    with open(args.output, 'w', newline='\n') as header:
+        header.write('#ifndef STATE_SPACE_GAINS_H_\n#define STATE_SPACE_GAINS_H_\n\n')
+        header.write('// Generated by tools/lqr-gains.py; regenerate rather than edit.\n')
+        header.write('// Plant %s; weights: error %g rpm, integral %g rpm s, action %g.\n\n'
+                     % (source, args.max_error, args.max_integral, args.max_action))
+        if args.raw_log:
+            header.write('// The log predates output linearization, so these gains assume the action is sent to the\n'
+                         '// motors as is: run the flywheel with MOTOR_TYPE_LINEAR until they are re-identified\n'
+                         '// from a log recorded with linearization on.\n\n')
+        for name, value, comment in constants:
+            header.write(('#define %s %.6ff' % (name, value)).ljust(48) + '// ' + comment + '\n')
+        header.write('\n#endif\n')
+
+    print('Plant gain %g rpm per action, time constant %g s' % (plantGain, timeConstant))
+    print('Error gain %g, integral gain %g' % (errorGain, integralGain))
+
+
+if __name__ == '__main__':
+    main()
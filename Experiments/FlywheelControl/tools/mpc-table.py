@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+"""
+Solves the flywheel's constrained model predictive control problem offline over
+a grid of (target, speed error, load), and writes the first action of each solution
+as an explicit MPC table to include/mpc-table.h and src/mpc-table.c.
+
+The plant is the first order model used by the state space controller,
+    d(speed)/dt = (plantGain * action - speed) / timeConstant - load,
+where load is the disturbance observer's estimated deceleration in rpm per
+second. By default the plant is read from include/state-space-gains.h, as
+written by lqr-gains.py.
+
+Each problem minimises the squared speed error over the horizon, plus a small
+penalty on the action's distance from the steady state action, subject to the
+action staying within +/-127. The inputs are held constant over blocks of
+several updates to keep the problem small. It is solved with accelerated
+projected gradient descent.
+
+The table is indexed by the error rather than the speed, as the unsaturated
+actions lie in a narrow band around zero error; the error range should cover
+that band, beyond which the actions are saturated anyway.
+
+Usage:
+    mpc-table.py
+    mpc-table.py --gain 13.5 --tau 0.69 --max-target 1800
+"""
+
+import argparse
+import math
+import os
+import re
+
+
+ROOT = os.path.join(os.path.dirname(__file__), '..')
+GAINS_PATH = os.path.join(ROOT, 'include', 'state-space-gains.h')
+HEADER_PATH = os.path.join(ROOT, 'include', 'mpc-table.h')
+SOURCE_PATH = os.path.join(ROOT, 'src', 'mpc-table.c')
+
+
+def readPlant(path):
+    """Reads the plant gain and time constant from the state space gains header."""
+    with open(path) as header:
+        text = header.read()
+    def constant(name):
+        match = re.search(r'#define\s+' + name + r'\s+([-0-9.eE+]+)f?', text)
+        if not match:
+            raise SystemExit('%s not found in %s' % (name, path))
+        return float(match.group(1))
+    return constant('STATE_SPACE_PLANT_GAIN'), constant('STATE_SPACE_TIME_CONSTANT')
+
+
+class Problem:
+    """The box constrained quadratic program shared by every grid point, for one plant."""
+
+    def __init__(self, plantGain, timeConstant, period, blocks, blockLength, maxError, maxAction):
+        self.plantGain = plantGain
+        self.timeConstant = timeConstant
+        self.blocks = blocks
+        self.maxAction = maxAction
+        steps = blocks * blockLength
+        a = math.exp(-period / timeConstant)
+        self.inputGain = plantGain * (1.0 - a)
+        self.loadGain = -timeConstant * (1.0 - a)
+
+        # speed[k] = free[k] + sum_j G[k][j] * action[j], where free[k] is the response with no action.
+        self.decay = [a ** (k + 1) for k in range(steps)]
+        self.loadResponse = [self.loadGain * sum(a ** i for i in range(k + 1)) for k in range(steps)]
+        self.G = [[0.0] * blocks for _ in range(steps)]
+        for k in range(steps):
+            for i in range(k + 1):
+                self.G[k][i // blockLength] += a ** (k - i) * self.inputGain
+
+        self.errorWeight = 1.0 / maxError ** 2
+        self.actionWeight = 0.01 / maxAction ** 2 * blockLength
+        # Hessian of the cost, and its largest eigenvalue for the gradient step size.
+        self.H = [[2.0 * (self.errorWeight * sum(self.G[k][i] * self.G[k][j] for k in range(steps))
+                          + (self.actionWeight if i == j else 0.0))
+                   for j in range(blocks)] for i in range(blocks)]
+        vector = [1.0] * blocks
+        for _ in range(200):
+            product = [sum(self.H[i][j] * vector[j] for j in range(blocks)) for i in range(blocks)]
+            norm = math.sqrt(sum(x * x for x in product))
+            vector = [x / norm for x in product]
+        self.stepSize = 1.0 / norm
+
+    def steady(self, target, load):
+        """The action that holds the target against the load, which may be beyond the limits."""
+        return (target + self.timeConstant * load) / self.plantGain
+
+    def solve(self, speed, target, load, iterations=300):
+        """Returns the first action of the constrained optimal sequence."""
+        steady = clamp(self.steady(target, load), -self.maxAction, self.maxAction)
+        offset = [speed * d + load * l - target for d, l in zip(self.decay, self.loadResponse)]
+        linear = [2.0 * (self.errorWeight * sum(self.G[k][j] * offset[k] for k in range(len(offset)))
+                         - self.actionWeight * steady)
+                  for j in range(self.blocks)]
+
+        actions = [steady] * self.blocks
+        momentum = actions[:]
+        t = 1.0
+        for _ in range(iterations):
+            gradient = [linear[i] + sum(self.H[i][j] * momentum[j] for j in range(self.blocks)) for i in range(self.blocks)]
+            following = [clamp(momentum[i] - self.stepSize * gradient[i], -self.maxAction, self.maxAction)
+                         for i in range(self.blocks)]
+            tNext = (1.0 + math.sqrt(1.0 + 4.0 * t * t)) / 2.0
+            momentum = [following[i] + (t - 1.0) / tNext * (following[i] - actions[i]) for i in range(self.blocks)]
+            actions, t = following, tNext
+        return actions[0]
+
+
+def clamp(value, minimum, maximum):
+    return max(minimum, min(maximum, value))
+
+
+def grid(maximum, nodes):
+    return [maximum * i / (nodes - 1) for i in range(nodes)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--gain', type=float, help='steady state rpm per unit of action; read from the gains header if not given')
+    parser.add_argument('--tau', type=float, help='time constant of the speed response, in seconds')
+    parser.add_argument('--period', type=float, default=0.02, help='controller update period while active, in seconds')
+    parser.add_argument('--blocks', type=int, default=10, help='number of input blocks in the horizon')
+    parser.add_argument('--block-length', type=int, default=5, help='updates each input block is held for')
+    parser.add_argument('--max-error', type=float, default=50.0, help='acceptable speed error, in rpm')
+    parser.add_argument('--max-action', type=float, default=127.0, help='action limit')
+    parser.add_argument('--max-target', type=float, help='highest target in the table, in rpm; the fastest reachable by default')
+    parser.add_argument('--max-table-error', type=float, default=600.0, help='the table covers errors within +/- this, in rpm')
+    parser.add_argument('--max-load', type=float, default=1000.0, help='highest estimated load in the table, in rpm per second')
+    parser.add_argument('--target-nodes', type=int, default=17)
+    parser.add_argument('--error-nodes', type=int, default=49)
+    parser.add_argument('--load-nodes', type=int, default=5)
+    args = parser.parse_args()
+
+    if args.gain and args.tau:
+        plantGain, timeConstant = args.gain, args.tau
+        source = 'given'
+    else:
+        plantGain, timeConstant = readPlant(GAINS_PATH)
+        source = 'from state-space-gains.h'
+    maxTarget = args.max_target or plantGain * args.max_action
+
+    problem = Problem(plantGain, timeConstant, args.period, args.blocks, args.block_length, args.max_error, args.max_action)
+    targets = grid(maxTarget, args.target_nodes)
+    errors = [error - args.max_table_error for error in grid(2.0 * args.max_table_error, args.error_nodes)]
+    loads = grid(args.max_load, args.load_nodes)
+
+    table = []
+    unsaturated = 0
+    for load in loads:
+        for target in targets:
+            row = [int(round(problem.solve(target + error, target, load))) for error in errors]
+            table.extend(row)
+            # Errors beyond the table are clamped to its ends, so the ends should already be settled,
+            # at least where the target can be held against the load at all.
+            if abs(problem.steady(target, load)) < args.max_action:
+                below = int(round(problem.solve(target + 2.0 * errors[0], target, load)))
+                above = int(round(problem.solve(target + 2.0 * errors[-1], target, load)))
+                if row[0] != below or row[-1] != above:
+                    unsaturated += 1
+    if unsaturated:
+        print('Warning: %d rows still change beyond the ends of the error range; consider a wider --max-table-error' % unsaturated)
+
+    size = len(table)
+    with open(HEADER_PATH, 'w', newline='\n') as header:
+        header.write('#ifndef MPC_TABLE_H_\n#define MPC_TABLE_H_\n\n')
+        header.write('// Generated by tools/mpc-table.py; regenerate rather than edit.\n')
+        header.write('// Plant %s: %g rpm per action, %g s time constant; horizon %d x %d updates of %g s.\n\n'
+                     % (source, plantGain, timeConstant, args.blocks, args.block_length, args.period))
+        header.write('#ifdef __cplusplus\nextern "C" {\n#endif\n\n')
+        defines = [
+            ('MPC_TABLE_LOAD_NODES', '%d' % args.load_nodes, 'Number of estimated loads in the table.'),
+            ('MPC_TABLE_TARGET_NODES', '%d' % args.target_nodes, 'Number of targets in the table.'),
+            ('MPC_TABLE_ERROR_NODES', '%d' % args.error_nodes, 'Number of speed errors in the table.'),
+            ('MPC_TABLE_TARGET_SPACING', '%.6ff' % (maxTarget / (args.target_nodes - 1)), 'Rpm between each target node, from zero.'),
+            ('MPC_TABLE_ERROR_MINIMUM', '%.6ff' % -args.max_table_error, 'Speed error, measured minus target, of the first error node.'),
+            ('MPC_TABLE_ERROR_SPACING', '%.6ff' % (2.0 * args.max_table_error / (args.error_nodes - 1)), 'Rpm between each error node.'),
+            ('MPC_TABLE_LOAD_SPACING', '%.6ff' % (args.max_load / (args.load_nodes - 1)), 'Rpm per second between each load node, from zero.'),
+        ]
+        for name, value, comment in defines:
+            header.write(('#define %s %s' % (name, value)).ljust(48) + '// ' + comment + '\n')
+        header.write('\n')
+        header.write('//\n// Optimal first actions, indexed [load][target][error].\n//\n')
+        header.write('extern const signed char mpcTable[MPC_TABLE_LOAD_NODES][MPC_TABLE_TARGET_NODES][MPC_TABLE_ERROR_NODES];\n\n')
+        header.write('// End C++ export structure\n#ifdef __cplusplus\n}\n#endif\n\n// End include guard\n#endif\n')
+
+    with open(SOURCE_PATH, 'w', newline='\n') as source:
+        source.write('#include "mpc-table.h"\n\n')
+        source.write('// Generated by tools/mpc-table.py; regenerate rather than edit.\n\n')
+        source.write('const signed char mpcTable[MPC_TABLE_LOAD_NODES][MPC_TABLE_TARGET_NODES][MPC_TABLE_ERROR_NODES] =\n{\n')
+        index = 0
+        for l in range(args.load_nodes):
+            source.write('\t{\n')
+            for t in range(args.target_nodes):
+                row = table[index:index + args.error_nodes]
+                index += args.error_nodes
+                source.write('\t\t{ ' + ', '.join('%d' % value for value in row) + ' },\n')
+            source.write('\t},\n')
+        source.write('};\n')
+
+    print('%d entries, %d bytes' % (size, size))
+
+
+if __name__ == '__main__':
+    main()
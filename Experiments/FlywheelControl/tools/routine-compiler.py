@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""
+Compiles an autonomous routine into the bytecode run by src/routine.c, and
+prints the Routine commands that upload it over the serial link. Upload with
+the robot disabled; the last command saves it to the Cortex's file system,
+once it has checked the upload against the routine's length and CRC.
+
+A routine is one instruction per line, with # starting a comment:
+
+    flywheel <rpm>                  sets the flywheel target
+    drive <inches> [speed <in/s>]   drives straight, backwards if negative
+    turn <degrees> [speed <in/s>]   turns on the spot, counter-clockwise if positive
+    wait-ready [<milliseconds>]     waits for the flywheel to be ready, or the timeout
+    fire [<count>]                  fires balls, and waits for them to be fed
+    wait <milliseconds>             waits
+    parallel                        runs the branches that follow together,
+    branch                          each started by branch,
+    end                             until all of them have ended
+
+Branches run side by side, so at most one of them should drive or turn.
+For example:
+
+    flywheel 1600
+    parallel
+    branch
+        drive 36
+        turn -45
+    branch
+        wait-ready 3000
+    end
+    fire 4
+
+Usage:
+    routine-compiler.py routine.txt
+    routine-compiler.py routine.txt --output routine.bin
+"""
+
+import argparse
+import binascii
+import struct
+import sys
+
+
+OPCODES = {
+    'end': 0,
+    'drive': 1,
+    'turn': 2,
+    'flywheel': 3,
+    'wait-ready': 4,
+    'fire': 5,
+    'wait': 6,
+    'parallel': 7,
+}
+
+MAX_SIZE = 512                  # ROUTINE_MAX_SIZE in include/routine.h.
+MAX_THREADS = 8                 # ROUTINE_MAX_THREADS in src/routine.c.
+UPLOAD_CHUNK = 48               # Bytes per upload command, to fit the Cortex's 128 character request buffer.
+DEFAULT_DRIVE_SPEED = 30
+DEFAULT_TURN_SPEED = 20
+
+
+class CompileError(Exception):
+    def __init__(self, line, message):
+        super().__init__('line %d: %s' % (line, message))
+
+
+def number(line, text, minimum, maximum):
+    try:
+        value = float(text)
+    except ValueError:
+        raise CompileError(line, 'expected a number, got %r' % text)
+    if not minimum <= value <= maximum:
+        raise CompileError(line, '%g is outside %g to %g' % (value, minimum, maximum))
+    return value
+
+
+def speedOperand(line, words, default):
+    if len(words) == 0:
+        return default
+    if len(words) != 2 or words[0] != 'speed':
+        raise CompileError(line, 'expected speed <in/s>')
+    return int(round(number(line, words[1], 1, 255)))
+
+
+def compileInstruction(line, words):
+    name, operands = words[0], words[1:]
+    if name == 'drive' and len(operands) >= 1:
+        tenths = int(round(number(line, operands[0], -3276.8, 3276.7) * 10))
+        return struct.pack('<BhB', OPCODES[name], tenths, speedOperand(line, operands[1:], DEFAULT_DRIVE_SPEED))
+    if name == 'turn' and len(operands) >= 1:
+        tenths = int(round(number(line, operands[0], -3276.8, 3276.7) * 10))
+        return struct.pack('<BhB', OPCODES[name], tenths, speedOperand(line, operands[1:], DEFAULT_TURN_SPEED))
+    if name == 'flywheel' and len(operands) == 1:
+        return struct.pack('<BH', OPCODES[name], int(round(number(line, operands[0], 0, 65535))))
+    if name == 'wait-ready' and len(operands) <= 1:
+        timeout = int(round(number(line, operands[0], 0, 65535))) if operands else 0
+        return struct.pack('<BH', OPCODES[name], timeout)
+    if name == 'fire' and len(operands) <= 1:
+        count = int(round(number(line, operands[0], 1, 255))) if operands else 1
+        return struct.pack('<BB', OPCODES[name], count)
+    if name == 'wait' and len(operands) == 1:
+        return struct.pack('<BH', OPCODES[name], int(round(number(line, operands[0], 0, 65535))))
+    raise CompileError(line, 'cannot parse %r' % ' '.join(words))
+
+
+def compileBlock(lines, index, isBranch):
+    """Compiles lines up to the end of a block, returning its bytecode, the threads it needs, and the next index."""
+    code = b''
+    threads = 1
+    while index < len(lines):
+        line, words = lines[index]
+        if words[0] in ('branch', 'end'):
+            if not isBranch:
+                raise CompileError(line, '%s outside a parallel block' % words[0])
+            return code + bytes([OPCODES['end']]), threads, index
+        index += 1
+        if words[0] != 'parallel':
+            code += compileInstruction(line, words)
+            continue
+
+        if len(words) != 1:
+            raise CompileError(line, 'parallel takes no operands')
+        branches = []
+        branchThreads = 1
+        while index < len(lines) and lines[index][1][0] == 'branch':
+            branchCode, needed, index = compileBlock(lines, index + 1, True)
+            branches.append(branchCode)
+            branchThreads += needed
+        if index >= len(lines) or lines[index][1][0] != 'end':
+            raise CompileError(line, 'parallel without branches ending in end')
+        if len(branches) > 255:
+            raise CompileError(line, 'too many branches')
+        index += 1
+        code += bytes([OPCODES['parallel'], len(branches)])
+        for branch in branches:
+            code += struct.pack('<H', len(branch)) + branch
+        threads = max(threads, branchThreads)
+    if isBranch:
+        raise CompileError(lines[-1][0], 'missing end')
+    return code + bytes([OPCODES['end']]), threads, index
+
+
+def compileRoutine(text):
+    lines = []
+    for number, line in enumerate(text.splitlines(), 1):
+        words = line.split('#', 1)[0].split()
+        if words:
+            lines.append((number, words))
+    code, threads, _ = compileBlock(lines, 0, False)
+    if len(code) > MAX_SIZE:
+        raise CompileError(0, 'routine is %d bytes, more than the %d that fit' % (len(code), MAX_SIZE))
+    if threads > MAX_THREADS:
+        raise CompileError(0, 'routine runs %d branches at once, more than %d' % (threads, MAX_THREADS))
+    return code
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('source', help='routine to compile')
+    parser.add_argument('--output', help='also write the bytecode to this file')
+    args = parser.parse_args()
+
+    with open(args.source) as source:
+        try:
+            code = compileRoutine(source.read())
+        except CompileError as error:
+            sys.exit('%s: %s' % (args.source, error))
+    if args.output:
+        with open(args.output, 'wb') as output:
+            output.write(code)
+
+    print('Routine clear')
+    for start in range(0, len(code), UPLOAD_CHUNK):
+        print('Routine ' + code[start:start + UPLOAD_CHUNK].hex())
+    # CRC-16/CCITT, matching routineCrc in src/routine.c.
+    print('Routine save %d %d' % (len(code), binascii.crc_hqx(code, 0xFFFF)))
+    print('%d bytes' % len(code), file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,58 @@
+#ifndef MOTORS_H_
+#define MOTORS_H_
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//
+// A set of motor channels that are driven together, with the reversed
+// channels kept as a precomputed sign mask.
+//
+typedef struct MotorGroup
+{
+	unsigned short channelMask;         // Bit n is set if channel n is in the group.
+	unsigned short reversedMask;        // Bit n is set if channel n is reversed.
+}
+MotorGroup;
+
+//
+// Makes a group from a zero-terminated list of at most count channels.
+//
+MotorGroup motorGroupInit(const unsigned char *channels, const bool *reversed, int count);
+
+//
+// Queues a value for every channel in the group, reversing where needed.
+// Nothing is sent to the motors until motorsFlush is called.
+//
+void motorGroupSet(const MotorGroup *group, int value);
+
+//
+// Queues a value for a single channel.
+// Nothing is sent to the motors until motorsFlush is called.
+//
+void motorsSet(unsigned char channel, int value);
+
+//
+// Sends, in one pass, every queued value that differs from what its channel was last sent.
+// Not locked, so call it from a single task; each call only sends what has changed.
+//
+void motorsFlush();
+
+//
+// Number of motorSet calls made, and number skipped because the value had not changed.
+//
+unsigned long motorsWriteCount();
+unsigned long motorsSkipCount();
+
+
+// End C++ export structure
+#ifdef __cplusplus
+}
+#endif
+
+// End include guard
+#endif
@@ -0,0 +1,95 @@
+#include "motors.h"
+
+#include <API.h>
+
+
+
+
+#define MOTORS_CHANNEL_COUNT 10                 // Number of motor channels on the Cortex, numbered from 1.
+
+
+
+
+short motorsQueued[MOTORS_CHANNEL_COUNT + 1];      // Values to send, indexed by channel.
+short motorsSent[MOTORS_CHANNEL_COUNT + 1];        // Values last sent, indexed by channel.
+unsigned short motorsUsedMask = 0;      // Bit n is set if channel n has ever been given a value.
+unsigned short motorsSentMask = 0;      // Bit n is set if channel n is known to still hold its last sent value.
+unsigned long motorsWrites = 0;
+unsigned long motorsSkips = 0;
+
+
+
+
+MotorGroup motorGroupInit(const unsigned char *channels, const bool *reversed, int count)
+{
+	MotorGroup group = { 0, 0 };
+	for (int i = 0; i < count && channels[i]; i++)
+	{
+		group.channelMask |= 1 << channels[i];
+		if (reversed[i])
+		{
+			group.reversedMask |= 1 << channels[i];
+		}
+	}
+	motorsUsedMask |= group.channelMask;
+	return group;
+}
+
+
+void motorGroupSet(const MotorGroup *group, int value)
+{
+	for (int channel = 1; channel <= MOTORS_CHANNEL_COUNT; channel++)
+	{
+		if (group->channelMask & (1 << channel))
+		{
+			motorsQueued[channel] = (group->reversedMask & (1 << channel))? -value : value;
+		}
+	}
+}
+
+
+void motorsSet(unsigned char channel, int value)
+{
+	motorsQueued[channel] = value;
+	motorsUsedMask |= 1 << channel;
+}
+
+
+void motorsFlush()
+{
+	// The kernel stops all motors while disabled, so the sent values can no longer be trusted.
+	if (!isEnabled())
+	{
+		motorsSentMask = 0;
+	}
+
+	for (int channel = 1; channel <= MOTORS_CHANNEL_COUNT; channel++)
+	{
+		if (!(motorsUsedMask & (1 << channel)))
+		{
+			continue;
+		}
+		short value = motorsQueued[channel];
+		if ((motorsSentMask & (1 << channel)) && value == motorsSent[channel])
+		{
+			++motorsSkips;
+			continue;
+		}
+		motorSet(channel, value);
+		motorsSent[channel] = value;
+		motorsSentMask |= 1 << channel;
+		++motorsWrites;
+	}
+}
+
+
+unsigned long motorsWriteCount()
+{
+	return motorsWrites;
+}
+
+
+unsigned long motorsSkipCount()
+{
+	return motorsSkips;
+}
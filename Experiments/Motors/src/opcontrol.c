@@ -52,19 +52,19 @@
  * This task should never exit; it should end with some kind of infinite loop, even if empty.
  */
 void operatorControl() {
+	const unsigned char leftChannels[5] = { 1, 2, 3, 4, 5 };
+	const unsigned char rightChannels[5] = { 6, 7, 8, 9, 10 };
+	const bool notReversed[5] = { false, false, false, false, false };
+	MotorGroup left = motorGroupInit(leftChannels, notReversed, 5);
+	MotorGroup right = motorGroupInit(rightChannels, notReversed, 5);
+	unsigned int count = 0;
 	while (1) {
-		int left = joystickGetAnalog(1, 3);
-		int right = joystickGetAnalog(1, 2);
-		motorSet(1, left);
-		motorSet(2, left);
-		motorSet(3, left);
-		motorSet(4, left);
-		motorSet(5, left);
-		motorSet(6, right);
-		motorSet(7, right);
-		motorSet(8, right);
-		motorSet(9, right);
-		motorSet(10, right);
+		motorGroupSet(&left, joystickGetAnalog(1, 3));
+		motorGroupSet(&right, joystickGetAnalog(1, 2));
+		motorsFlush();
+		if (++count % 250 == 0) {
+			printf("Motors %lu written %lu skipped\n", motorsWriteCount(), motorsSkipCount());
+		}
 		delay(20);
 	}
 }